@@ -0,0 +1,80 @@
+#include "arena.h"
+
+#include <stdio.h>
+#include <string.h>
+
+struct ArenaBlock {
+    ArenaBlock* Next;
+    size_t Size;
+    size_t Used;
+};
+
+#define ARENA_HEADER_SIZE ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+static ArenaBlock*
+CreateBlock(size_t size) {
+    ArenaBlock* Block = (ArenaBlock*)PlatformAllocPages(&size, size >= ARENA_LARGE_PAGE_THRESHOLD);
+    if(!Block) {
+        return NULL;
+    }
+
+    Block->Next = NULL;
+    Block->Size = size;
+    Block->Used = ARENA_HEADER_SIZE;
+    return Block;
+}
+
+int
+ArenaInit(Arena* arena, size_t capacity) {
+    memset(arena, 0, sizeof(Arena));
+    arena->Lock = MutexCreate();
+    arena->NextBlockSize = capacity + ARENA_HEADER_SIZE > ARENA_MIN_BLOCK_SIZE ? capacity + ARENA_HEADER_SIZE : ARENA_MIN_BLOCK_SIZE;
+    arena->Head = arena->Lock ? CreateBlock(arena->NextBlockSize) : NULL;
+    if(!arena->Head) {
+        fprintf(stderr, "Failed to reserve %llu bytes of staging memory.\n", (unsigned long long)capacity);
+        ArenaRelease(arena);
+        return 0;
+    }
+
+    arena->NextBlockSize = arena->Head->Size * 2;
+    return 1;
+}
+
+void*
+ArenaAlloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    MutexLock(arena->Lock);
+    ArenaBlock* Block = arena->Head;
+    // NOTE(Jovan): Space left in the previous block is abandoned, estimates are meant to make this rare
+    if(Block->Size - Block->Used < size) {
+        size_t BlockSize = arena->NextBlockSize > size + ARENA_HEADER_SIZE ? arena->NextBlockSize : size + ARENA_HEADER_SIZE;
+        Block = CreateBlock(BlockSize);
+        if(!Block) {
+            MutexUnlock(arena->Lock);
+            fprintf(stderr, "Failed to grow staging memory by %llu bytes.\n", (unsigned long long)BlockSize);
+            return NULL;
+        }
+        Block->Next = arena->Head;
+        arena->Head = Block;
+        arena->NextBlockSize = Block->Size * 2;
+    }
+
+    void* Result = (unsigned char*)Block + Block->Used;
+    Block->Used += size;
+    arena->Used += size;
+    MutexUnlock(arena->Lock);
+    return Result;
+}
+
+void
+ArenaRelease(Arena* arena) {
+    while(arena->Head) {
+        ArenaBlock* Next = arena->Head->Next;
+        PlatformFreePages(arena->Head, arena->Head->Size);
+        arena->Head = Next;
+    }
+    if(arena->Lock) {
+        MutexDestroy(arena->Lock);
+    }
+    memset(arena, 0, sizeof(Arena));
+}
@@ -0,0 +1,62 @@
+/**
+ * @file arena.h
+ * @author Jovan Ivosevic
+ * @brief Linear allocator for short lived staging memory
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "platform.h"
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_MIN_BLOCK_SIZE (1u << 20)
+// NOTE(Jovan): Blocks at least this large ask for large pages, smaller ones would waste most of a page
+#define ARENA_LARGE_PAGE_THRESHOLD (16u << 20)
+
+typedef struct ArenaBlock ArenaBlock;
+
+/**
+ * @brief Hands out memory by bumping an offset and releases all of it at once. Capacity is
+ *        reserved up front, running out chains a new block twice the size of the last one.
+ *        Allocation is safe from several threads.
+ *
+ */
+typedef struct Arena {
+    ArenaBlock* Head;
+    Mutex* Lock;
+    size_t NextBlockSize;
+    uint64_t Used;
+} Arena;
+
+/**
+ * @brief Prepares arena and allocates its first block
+ *
+ * @param arena Zeroed arena
+ * @param capacity Expected total of all allocations
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ArenaInit(Arena* arena, size_t capacity);
+
+/**
+ * @brief Allocates ARENA_ALIGNMENT aligned memory. Contents are undefined.
+ *
+ * @param arena Initialized arena
+ * @param size Size in bytes, may be 0
+ * @return void* Memory, NULL on failure
+ */
+void* ArenaAlloc(Arena* arena, size_t size);
+
+/**
+ * @brief Releases every block of the arena. Safe to call on zeroed arena.
+ *
+ * @param arena Arena
+ */
+void ArenaRelease(Arena* arena);
+
+#endif
@@ -0,0 +1,120 @@
+#include "assimpio.h"
+#include "vfs.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct MemoryFile {
+    struct aiFile File;
+    VfsFile Source;
+    const char* Data;
+    size_t Size;
+    size_t Position;
+} MemoryFile;
+
+static size_t
+MemoryFileRead(struct aiFile* file, char* buffer, size_t size, size_t count) {
+    MemoryFile* Curr = (MemoryFile*)file->UserData;
+    if(!size) {
+        return 0;
+    }
+
+    size_t Available = (Curr->Size - Curr->Position) / size;
+    size_t NumRead = count < Available ? count : Available;
+    memcpy(buffer, Curr->Data + Curr->Position, NumRead * size);
+    Curr->Position += NumRead * size;
+    return NumRead;
+}
+
+static size_t
+MemoryFileWrite(struct aiFile* file, const char* buffer, size_t size, size_t count) {
+    (void)file;
+    (void)buffer;
+    (void)size;
+    (void)count;
+    return 0;
+}
+
+static size_t
+MemoryFileTell(struct aiFile* file) {
+    return ((MemoryFile*)file->UserData)->Position;
+}
+
+static size_t
+MemoryFileSize(struct aiFile* file) {
+    return ((MemoryFile*)file->UserData)->Size;
+}
+
+static void
+MemoryFileFlush(struct aiFile* file) {
+    (void)file;
+}
+
+static enum aiReturn
+MemoryFileSeek(struct aiFile* file, size_t offset, enum aiOrigin origin) {
+    MemoryFile* Curr = (MemoryFile*)file->UserData;
+    // NOTE(Jovan): Relative offsets arrive as size_t, negative ones wrap around and land back in range
+    size_t Position;
+    switch(origin) {
+        case aiOrigin_SET: Position = offset; break;
+        case aiOrigin_CUR: Position = Curr->Position + offset; break;
+        case aiOrigin_END: Position = Curr->Size + offset; break;
+        default: return aiReturn_FAILURE;
+    }
+
+    if(Position > Curr->Size) {
+        return aiReturn_FAILURE;
+    }
+    Curr->Position = Position;
+    return aiReturn_SUCCESS;
+}
+
+static struct aiFile*
+AssimpFileOpen(struct aiFileIO* io, const char* filePath, const char* mode) {
+    if(strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+')) {
+        return NULL;
+    }
+
+    MemoryFile* Result = (MemoryFile*)calloc(1, sizeof(MemoryFile));
+    if(!Result) {
+        return NULL;
+    }
+
+    // NOTE(Jovan): Assimp probes sibling files (.mtl and such) by opening them, misses are not errors
+    if(!VfsOpenFile(filePath, &Result->Source)) {
+        free(Result);
+        return NULL;
+    }
+    Result->Data = Result->Source.Data;
+    Result->Size = Result->Source.Size;
+    AddModelSource((ModelSources*)io->UserData, filePath, &Result->Source);
+
+    Result->File.ReadProc = MemoryFileRead;
+    Result->File.WriteProc = MemoryFileWrite;
+    Result->File.TellProc = MemoryFileTell;
+    Result->File.FileSizeProc = MemoryFileSize;
+    Result->File.SeekProc = MemoryFileSeek;
+    Result->File.FlushProc = MemoryFileFlush;
+    Result->File.UserData = (aiUserData)Result;
+    return &Result->File;
+}
+
+static void
+AssimpFileClose(struct aiFileIO* io, struct aiFile* file) {
+    (void)io;
+    if(!file) {
+        return;
+    }
+
+    MemoryFile* Curr = (MemoryFile*)file->UserData;
+    VfsCloseFile(&Curr->Source);
+    free(Curr);
+}
+
+void
+InitAssimpFileIO(struct aiFileIO* io, ModelSources* sources) {
+    memset(io, 0, sizeof(struct aiFileIO));
+    io->OpenProc = AssimpFileOpen;
+    io->CloseProc = AssimpFileClose;
+    io->UserData = (aiUserData)sources;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file assimpio.h
+ * @author Jovan Ivosevic
+ * @brief Assimp file system serving reads from the asset pack or memory mapped files
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ASSIMPIO_H
+#define ASSIMPIO_H
+
+#include <stddef.h>
+#include <assimp/types.h>
+#include "model.h"
+
+// NOTE(Jovan): Assimp 3.0 cfileio.h uses these names without struct/enum, which only compiles as C++
+typedef struct aiFile aiFile;
+typedef enum aiReturn aiReturn;
+typedef enum aiOrigin aiOrigin;
+#include <assimp/cfileio.h>
+
+/**
+ * @brief Prepares file system for aiImportFileEx(filePath, flags, io). Files, including the ones
+ *        referenced by the model, are opened through the VFS, so they come from the mounted asset pack
+ *        when it has them and are memory mapped from disk otherwise. Opening for writing fails,
+ *        Assimp only needs it for export.
+ *
+ * @param io File system
+ * @param sources Receives keys of every file Assimp opened, taken from the views it read
+ */
+void InitAssimpFileIO(struct aiFileIO* io, ModelSources* sources);
+
+#endif
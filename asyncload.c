@@ -0,0 +1,359 @@
+#include "asyncload.h"
+#include "meshcache.h"
+#include "platform.h"
+#include "jobs.h"
+
+#include <string.h>
+
+#define LOAD_STAGE_FAILED -1
+#define LOAD_STAGE_IMPORTING 0
+#define LOAD_STAGE_IMPORTED 1
+#define LOAD_STAGE_UPLOADED 2
+
+struct ModelLoad {
+    char* FilePath;
+    Model* Target;
+    // NOTE(Jovan): Reloads stream into Replacement and swap it with SwapTarget once complete
+    Model* SwapTarget;
+    Model Replacement;
+    BakedModel Baked;
+    unsigned NumMeshes;
+    // NOTE(Jovan): Mesh table from the import job and buffer names from the upload thread, copied to Target on the render thread
+    Model Staging;
+    // NOTE(Jovan): Written by import and upload, read by the render thread once uploads are done
+    LoadProfile Profile;
+    GLsync* Fences;
+    volatile long Stage;
+    volatile long NumUploaded;
+    volatile long References;
+    unsigned NumResident;
+    int Published;
+    int State;
+    struct ModelLoad* NextUpload;
+    struct ModelLoad* NextActive;
+};
+
+typedef struct AsyncLoader {
+    GLFWwindow* UploadWindow;
+    Thread* UploadThread;
+    Mutex* Lock;
+    CondVar* Changed;
+    ModelLoad* UploadHead;
+    ModelLoad* UploadTail;
+    ModelLoad* Active;
+    long InFlightImports;
+    int Quit;
+} AsyncLoader;
+
+static AsyncLoader sLoader;
+
+static void
+FreeStagingBaked(ModelLoad* load) {
+    uint64_t Start = ProfileStart();
+    uint64_t Bytes = load->Baked.File.Data || !load->Baked.Header ? 0 : load->Baked.Header->FileSize;
+    FreeBakedModel(&load->Baked);
+    ProfileAddStage(&load->Profile, PROFILE_STAGE_TEARDOWN, ProfileElapsed(Start), Bytes);
+}
+
+static int
+UploadThreadMain(void* arg) {
+    (void)arg;
+    glfwMakeContextCurrent(sLoader.UploadWindow);
+    for(;;) {
+        MutexLock(sLoader.Lock);
+        while(!sLoader.UploadHead && !sLoader.Quit) {
+            CondVarWait(sLoader.Changed, sLoader.Lock);
+        }
+
+        if(sLoader.Quit) {
+            MutexUnlock(sLoader.Lock);
+            break;
+        }
+
+        ModelLoad* Load = sLoader.UploadHead;
+        sLoader.UploadHead = Load->NextUpload;
+        if(!sLoader.UploadHead) {
+            sLoader.UploadTail = NULL;
+        }
+        MutexUnlock(sLoader.Lock);
+
+        // NOTE(Jovan): Fence per mesh lets the render thread pick up meshes while the rest still streams
+        CreateModelBuffers(&Load->Baked, &Load->Staging, &Load->Profile);
+        for(unsigned MeshIdx = 0; MeshIdx < Load->NumMeshes; ++MeshIdx) {
+            UploadMeshBuffers(&Load->Baked, MeshIdx, &Load->Staging, &Load->Profile);
+            Load->Fences[MeshIdx] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+            AtomicIncrement(&Load->NumUploaded);
+        }
+
+        FreeStagingBaked(Load);
+        AtomicStore(&Load->Stage, LOAD_STAGE_UPLOADED);
+    }
+
+    glfwMakeContextCurrent(NULL);
+    return 0;
+}
+
+int
+InitAsyncLoader(GLFWwindow* mainWindow) {
+    sLoader.Lock = MutexCreate();
+    sLoader.Changed = CondVarCreate();
+    if(!sLoader.Lock || !sLoader.Changed) {
+        fprintf(stderr, "Failed to allocate async loader.\n");
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Context hints set for the main window still apply, which sharing requires
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    sLoader.UploadWindow = glfwCreateWindow(1, 1, "", NULL, mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if(!sLoader.UploadWindow) {
+        fprintf(stderr, "Failed to create upload context, uploads will run on the main thread.\n");
+        return LOAD_FAIL;
+    }
+
+    sLoader.UploadThread = ThreadCreate(UploadThreadMain, NULL);
+    if(!sLoader.UploadThread) {
+        fprintf(stderr, "Failed to start upload thread, uploads will run on the main thread.\n");
+        glfwDestroyWindow(sLoader.UploadWindow);
+        sLoader.UploadWindow = NULL;
+        return LOAD_FAIL;
+    }
+
+    return LOAD_SUCCESS;
+}
+
+static void
+ReleaseLoad(ModelLoad* load) {
+    if(AtomicDecrement(&load->References)) {
+        return;
+    }
+
+    free(load->FilePath);
+    free(load->Fences);
+    FreeLoadProfile(&load->Profile);
+    free(load);
+}
+
+static void
+ImportJob(void* data) {
+    ModelLoad* Load = (ModelLoad*)data;
+    long Stage = LOAD_STAGE_FAILED;
+    if(ImportBakedModel(Load->FilePath, &Load->Baked, &Load->Profile)) {
+        Load->NumMeshes = Load->Baked.Header->NumMeshes;
+        Load->Fences = (GLsync*)calloc(Load->NumMeshes ? Load->NumMeshes : 1, sizeof(GLsync));
+        if(Load->Fences && InitModelMeshes(&Load->Baked, &Load->Staging)) {
+            Stage = LOAD_STAGE_IMPORTED;
+        } else {
+            fprintf(stderr, "Failed to allocate uploads for %s.\n", Load->FilePath);
+            FreeBakedModel(&Load->Baked);
+        }
+    }
+
+    MutexLock(sLoader.Lock);
+    if(Stage == LOAD_STAGE_IMPORTED && sLoader.UploadThread) {
+        if(sLoader.UploadTail) {
+            sLoader.UploadTail->NextUpload = Load;
+        } else {
+            sLoader.UploadHead = Load;
+        }
+        sLoader.UploadTail = Load;
+    }
+    AtomicStore(&Load->Stage, Stage);
+    --sLoader.InFlightImports;
+    CondVarBroadcast(sLoader.Changed);
+    MutexUnlock(sLoader.Lock);
+}
+
+static ModelLoad*
+StartLoad(const char* filePath, Model* model, int swap) {
+    ModelLoad* Load = (ModelLoad*)calloc(1, sizeof(ModelLoad));
+    size_t PathLength = strlen(filePath) + 1;
+    char* FilePath = (char*)malloc(PathLength);
+    if(!Load || !FilePath || !sLoader.Lock) {
+        fprintf(stderr, "Failed to start loading %s.\n", filePath);
+        free(Load);
+        free(FilePath);
+        return NULL;
+    }
+
+    memcpy(FilePath, filePath, PathLength);
+    Load->FilePath = FilePath;
+    Load->Target = swap ? &Load->Replacement : model;
+    Load->SwapTarget = swap ? model : NULL;
+    Load->State = MODEL_LOAD_PENDING;
+    // NOTE(Jovan): One reference for the caller, one for the active list
+    Load->References = 2;
+    Load->NextActive = sLoader.Active;
+    sLoader.Active = Load;
+
+    MutexLock(sLoader.Lock);
+    ++sLoader.InFlightImports;
+    MutexUnlock(sLoader.Lock);
+    JobSubmit(ImportJob, Load);
+    return Load;
+}
+
+ModelLoad*
+LoadModelAsync(const char* filePath, Model* model) {
+    memset(model, 0, sizeof(Model));
+    return StartLoad(filePath, model, 0);
+}
+
+ModelLoad*
+ReloadModelAsync(const char* filePath, Model* model) {
+    return StartLoad(filePath, model, 1);
+}
+
+/**
+ * @brief Replaces model being reloaded with its fully resident new version
+ *
+ */
+static void
+SwapModel(ModelLoad* load) {
+    FreeModelResources(load->SwapTarget);
+    *load->SwapTarget = load->Replacement;
+    memset(&load->Replacement, 0, sizeof(Model));
+}
+
+static void
+PublishMeshes(ModelLoad* load) {
+    Model* Target = load->Target;
+    // NOTE(Jovan): Without an upload thread the render thread uploads everything at once
+    if(!sLoader.UploadThread && AtomicLoad(&load->Stage) == LOAD_STAGE_IMPORTED) {
+        CreateModelBuffers(&load->Baked, &load->Staging, &load->Profile);
+        for(unsigned MeshIdx = 0; MeshIdx < load->NumMeshes; ++MeshIdx) {
+            UploadMeshBuffers(&load->Baked, MeshIdx, &load->Staging, &load->Profile);
+        }
+        FreeStagingBaked(load);
+        *Target = load->Staging;
+        CreateModelVertexArray(Target);
+        load->Published = 1;
+        load->NumResident = load->NumMeshes;
+        Target->NumResident = load->NumResident;
+        AtomicStore(&load->Stage, LOAD_STAGE_UPLOADED);
+        return;
+    }
+
+    unsigned NumUploaded = (unsigned)AtomicLoad(&load->NumUploaded);
+    unsigned NumResident = load->NumResident;
+    while(load->NumResident < NumUploaded) {
+        unsigned MeshIdx = load->NumResident;
+        GLenum Status = glClientWaitSync(load->Fences[MeshIdx], 0, 0);
+        if(Status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+
+        glDeleteSync(load->Fences[MeshIdx]);
+        load->Fences[MeshIdx] = NULL;
+        // NOTE(Jovan): Buffers exist for the render context once the first fence passed. Upload thread keeps
+        // reading Staging, so Target gets a copy and owns the memory from here on.
+        if(!load->Published) {
+            *Target = load->Staging;
+            CreateModelVertexArray(Target);
+            load->Published = 1;
+        }
+        Target->NumResident = ++load->NumResident;
+    }
+    // NOTE(Jovan): Meshes were written by the upload context, passed fences alone don't make them visible here
+    if(load->NumResident != NumResident) {
+        AttachModelBuffers(Target);
+    }
+
+    if(!load->Published && !load->NumMeshes && AtomicLoad(&load->Stage) == LOAD_STAGE_UPLOADED) {
+        *Target = load->Staging;
+        load->Published = 1;
+    }
+}
+
+void
+ProcessModelLoads(void) {
+    ModelLoad** Link = &sLoader.Active;
+    while(*Link) {
+        ModelLoad* Load = *Link;
+        long Stage = AtomicLoad(&Load->Stage);
+        if(Stage >= LOAD_STAGE_IMPORTED) {
+            PublishMeshes(Load);
+            // NOTE(Jovan): Upload thread is done with the load only once it reports the uploaded stage
+            if(Load->NumResident == Load->NumMeshes && AtomicLoad(&Load->Stage) == LOAD_STAGE_UPLOADED) {
+                fprintf(stdout, "Loaded %d meshes from %s in background, %.1f ms of work.\n", Load->NumMeshes, Load->FilePath,
+                        Load->Profile.TotalSeconds * 1000.0);
+                // NOTE(Jovan): Target was copied from Staging before uploads finished, profile is handed over only now
+                Load->Target->Profile = Load->Profile;
+                memset(&Load->Profile, 0, sizeof(LoadProfile));
+                if(Load->SwapTarget) {
+                    SwapModel(Load);
+                }
+                Load->State = MODEL_LOAD_READY;
+            }
+        } else if(Stage == LOAD_STAGE_FAILED) {
+            fprintf(stderr, "Failed to load %s in background%s.\n", Load->FilePath,
+                    Load->SwapTarget ? ", keeping previous version" : "");
+            Load->State = MODEL_LOAD_FAILED;
+        }
+
+        if(Load->State != MODEL_LOAD_PENDING) {
+            *Link = Load->NextActive;
+            ReleaseLoad(Load);
+            continue;
+        }
+        Link = &Load->NextActive;
+    }
+}
+
+int
+GetModelLoadState(const ModelLoad* load) {
+    return load->State;
+}
+
+void
+ReleaseModelLoad(ModelLoad* load) {
+    if(load) {
+        ReleaseLoad(load);
+    }
+}
+
+void
+ShutdownAsyncLoader(void) {
+    if(!sLoader.Lock) {
+        return;
+    }
+
+    MutexLock(sLoader.Lock);
+    sLoader.Quit = 1;
+    CondVarBroadcast(sLoader.Changed);
+    MutexUnlock(sLoader.Lock);
+    if(sLoader.UploadThread) {
+        ThreadJoin(sLoader.UploadThread);
+    }
+
+    // NOTE(Jovan): Imports hold pointers to their loads, let them finish before tearing down
+    MutexLock(sLoader.Lock);
+    while(sLoader.InFlightImports) {
+        CondVarWait(sLoader.Changed, sLoader.Lock);
+    }
+    MutexUnlock(sLoader.Lock);
+
+    while(sLoader.Active) {
+        ModelLoad* Load = sLoader.Active;
+        sLoader.Active = Load->NextActive;
+        for(unsigned MeshIdx = Load->NumResident; MeshIdx < (unsigned)Load->NumUploaded; ++MeshIdx) {
+            glDeleteSync(Load->Fences[MeshIdx]);
+        }
+        if(!Load->Published && AtomicLoad(&Load->Stage) != LOAD_STAGE_FAILED) {
+            FreeModelResources(&Load->Staging);
+        } else if(Load->Published && Load->SwapTarget) {
+            FreeModelResources(&Load->Replacement);
+        }
+        FreeBakedModel(&Load->Baked);
+        Load->State = MODEL_LOAD_FAILED;
+        ReleaseLoad(Load);
+    }
+
+    if(sLoader.UploadWindow) {
+        glfwDestroyWindow(sLoader.UploadWindow);
+    }
+    CondVarDestroy(sLoader.Changed);
+    MutexDestroy(sLoader.Lock);
+    memset(&sLoader, 0, sizeof(AsyncLoader));
+}
@@ -0,0 +1,84 @@
+/**
+ * @file asyncload.h
+ * @author Jovan Ivosevic
+ * @brief Background model loading with a shared-context GPU upload thread
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef ASYNCLOAD_H
+#define ASYNCLOAD_H
+
+#define MODEL_LOAD_FAILED -1
+#define MODEL_LOAD_PENDING 0
+#define MODEL_LOAD_READY 1
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "model.h"
+
+typedef struct ModelLoad ModelLoad;
+
+/**
+ * @brief Creates hidden context sharing objects with main window and starts upload thread.
+ *        Must be called from the main thread after GLEW is initialized. If it fails, async
+ *        loads still import on workers but upload on the main thread in ProcessModelLoads.
+ *
+ * @param mainWindow Window owning the render context
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int InitAsyncLoader(GLFWwindow* mainWindow);
+
+/**
+ * @brief Stops upload thread and destroys upload context. Loads still in flight are abandoned.
+ *
+ */
+void ShutdownAsyncLoader(void);
+
+/**
+ * @brief Starts loading model in the background and returns immediately. Model is zeroed
+ *        and gains meshes as they become resident; it must not be freed before the load
+ *        leaves the pending state.
+ *
+ * @param filePath Relative model file path
+ * @param model Model struct which will contain result. Should be allocated beforehand.
+ * @return ModelLoad* Load handle, release with ReleaseModelLoad. NULL on failure.
+ */
+ModelLoad* LoadModelAsync(const char* filePath, Model* model);
+
+/**
+ * @brief Loads new version of a model in the background. The model keeps rendering as it is until
+ *        the new version is fully resident, then ProcessModelLoads frees the old buffers and swaps
+ *        in the new ones between frames. If loading fails the old version stays.
+ *
+ * @param filePath Relative model file path
+ * @param model Model to be replaced, must stay alive until the load leaves the pending state
+ * @return ModelLoad* Load handle, release with ReleaseModelLoad. NULL on failure.
+ */
+ModelLoad* ReloadModelAsync(const char* filePath, Model* model);
+
+/**
+ * @brief Publishes finished uploads to their models. Call once per frame on the render thread.
+ *
+ */
+void ProcessModelLoads(void);
+
+/**
+ * @brief Returns load state
+ *
+ * @param load Load handle
+ * @return int MODEL_LOAD_PENDING, MODEL_LOAD_READY or MODEL_LOAD_FAILED
+ */
+int GetModelLoadState(const ModelLoad* load);
+
+/**
+ * @brief Releases load handle. Load itself keeps running if still pending.
+ *
+ * @param load Load handle
+ */
+void ReleaseModelLoad(ModelLoad* load);
+
+#endif
@@ -0,0 +1,111 @@
+#include "filewatch.h"
+#include "platform.h"
+#include "vfs.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct FileWatch {
+    char* FilePath;
+    FileChangedFunc Func;
+    void* Data;
+    uint64_t Size;
+    int64_t ModifiedTime;
+    int Exists;
+    int Pending;
+    // NOTE(Jovan): Loads read the packed copy, so changes of the loose file are never reported
+    int Packed;
+} FileWatch;
+
+static FileWatch* sWatches;
+static unsigned sNumWatches;
+static unsigned sCapacity;
+static uint64_t sLastPoll;
+
+int
+WatchFile(const char* filePath, FileChangedFunc func, void* data) {
+    for(unsigned WatchIdx = 0; WatchIdx < sNumWatches; ++WatchIdx) {
+        const FileWatch* Curr = &sWatches[WatchIdx];
+        if(Curr->Func == func && Curr->Data == data && !strcmp(Curr->FilePath, filePath)) {
+            return FILEWATCH_SUCCESS;
+        }
+    }
+
+    if(sNumWatches == sCapacity) {
+        unsigned Capacity = sCapacity ? 2 * sCapacity : 8;
+        FileWatch* Watches = (FileWatch*)realloc(sWatches, Capacity * sizeof(FileWatch));
+        if(!Watches) {
+            fprintf(stderr, "Failed to watch %s.\n", filePath);
+            return FILEWATCH_FAIL;
+        }
+        sWatches = Watches;
+        sCapacity = Capacity;
+    }
+
+    size_t PathLength = strlen(filePath) + 1;
+    FileWatch* Watch = &sWatches[sNumWatches];
+    memset(Watch, 0, sizeof(FileWatch));
+    Watch->FilePath = (char*)malloc(PathLength);
+    if(!Watch->FilePath) {
+        fprintf(stderr, "Failed to watch %s.\n", filePath);
+        return FILEWATCH_FAIL;
+    }
+
+    memcpy(Watch->FilePath, filePath, PathLength);
+    Watch->Func = func;
+    Watch->Data = data;
+    Watch->Packed = VfsIsPacked(filePath);
+    if(Watch->Packed) {
+        fprintf(stdout, "%s is served from the asset pack, its loose copy is not watched.\n", filePath);
+    }
+    Watch->Exists = PlatformFileStat(filePath, &Watch->Size, &Watch->ModifiedTime);
+    if(!sNumWatches++) {
+        sLastPoll = PlatformTimerTicks();
+    }
+    return FILEWATCH_SUCCESS;
+}
+
+void
+PollFileWatches(void) {
+    uint64_t Now = PlatformTimerTicks();
+    if(!sNumWatches || (double)(Now - sLastPoll) < FILEWATCH_INTERVAL * (double)PlatformTimerFrequency()) {
+        return;
+    }
+    sLastPoll = Now;
+
+    for(unsigned WatchIdx = 0; WatchIdx < sNumWatches; ++WatchIdx) {
+        FileWatch* Curr = &sWatches[WatchIdx];
+        if(Curr->Packed) {
+            continue;
+        }
+        uint64_t Size = 0;
+        int64_t ModifiedTime = 0;
+        int Exists = PlatformFileStat(Curr->FilePath, &Size, &ModifiedTime);
+        if(Exists != Curr->Exists || Size != Curr->Size || ModifiedTime != Curr->ModifiedTime) {
+            Curr->Exists = Exists;
+            Curr->Size = Size;
+            Curr->ModifiedTime = ModifiedTime;
+            Curr->Pending = 1;
+            continue;
+        }
+
+        // NOTE(Jovan): Editors that replace files may leave them missing for a moment, wait for the new one
+        if(Curr->Pending && Exists) {
+            Curr->Pending = 0;
+            fprintf(stdout, "%s changed, reloading.\n", Curr->FilePath);
+            Curr->Func(Curr->Data, Curr->FilePath);
+        }
+    }
+}
+
+void
+ClearFileWatches(void) {
+    for(unsigned WatchIdx = 0; WatchIdx < sNumWatches; ++WatchIdx) {
+        free(sWatches[WatchIdx].FilePath);
+    }
+    free(sWatches);
+    sWatches = NULL;
+    sNumWatches = 0;
+    sCapacity = 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file filewatch.h
+ * @author Jovan Ivosevic
+ * @brief Polls loose asset files for changes so they can be reloaded while running
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef FILEWATCH_H
+#define FILEWATCH_H
+
+#define FILEWATCH_SUCCESS 1
+#define FILEWATCH_FAIL 0
+// NOTE(Jovan): Seconds between stat sweeps. A change is reported on the sweep after it was seen and only
+//              if the file stayed the same in between, so editors saving in several writes trigger one reload.
+#define FILEWATCH_INTERVAL 0.25
+
+typedef void (*FileChangedFunc)(void* data, const char* filePath);
+
+/**
+ * @brief Starts watching file. Only loose files are watched, files the mounted asset pack serves are registered
+ *        but never reported, since loads keep reading the packed copy. Mount the pack before watching.
+ *        Watching a file again with the same handler and data does nothing.
+ *
+ * @param filePath Relative file path
+ * @param func Called from PollFileWatches once the file changed and settled
+ * @param data Passed to func
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int WatchFile(const char* filePath, FileChangedFunc func, void* data);
+
+/**
+ * @brief Checks watched files and calls handlers of changed ones. Call once per frame on the render
+ *        thread, handlers may issue GL calls. Does nothing until FILEWATCH_INTERVAL has passed.
+ *
+ */
+void PollFileWatches(void);
+
+/**
+ * @brief Stops watching all files
+ *
+ */
+void ClearFileWatches(void);
+
+#endif
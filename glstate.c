@@ -0,0 +1,260 @@
+#include "glstate.h"
+
+#include <string.h>
+
+#define STATE_NUM_CAPABILITIES 6
+#define STATE_NUM_TEXTURE_TARGETS 4
+
+typedef struct GlState {
+    int Initialized;
+    unsigned Program;
+    unsigned VAO;
+    unsigned ArrayBuffer;
+    // NOTE(Jovan): Element buffer binding belongs to the VAO, it is forgotten whenever the VAO changes
+    unsigned ElementBuffer;
+    unsigned UniformBuffer;
+    unsigned UniformBindings[STATE_MAX_UNIFORM_BINDINGS];
+    unsigned ActiveTexture;
+    unsigned Textures[STATE_MAX_TEXTURE_UNITS][STATE_NUM_TEXTURE_TARGETS];
+    unsigned Capabilities[STATE_NUM_CAPABILITIES];
+    unsigned DepthFunc;
+    unsigned DepthMask;
+    unsigned CullFace;
+    GlStateStats Stats;
+} GlState;
+
+static GlState sState;
+
+void
+StateInvalidate(void) {
+    GlStateStats Stats = sState.Stats;
+    // NOTE(Jovan): Every field is a name or enum, so filling bytes with 0xFF marks them all STATE_UNKNOWN
+    memset(&sState, 0xFF, sizeof(GlState));
+    sState.Initialized = 1;
+    sState.Stats = Stats;
+}
+
+static int
+StateChanged(unsigned* cached, unsigned value) {
+    if(!sState.Initialized) {
+        StateInvalidate();
+    }
+    if(*cached == value) {
+        ++sState.Stats.Elided;
+        return 0;
+    }
+
+    *cached = value;
+    ++sState.Stats.Issued;
+    return 1;
+}
+
+static unsigned*
+BufferSlot(GLenum target) {
+    switch(target) {
+    case GL_ARRAY_BUFFER: return &sState.ArrayBuffer;
+    case GL_ELEMENT_ARRAY_BUFFER: return &sState.ElementBuffer;
+    case GL_UNIFORM_BUFFER: return &sState.UniformBuffer;
+    default: return NULL;
+    }
+}
+
+static int
+TextureTargetIndex(GLenum target) {
+    switch(target) {
+    case GL_TEXTURE_2D: return 0;
+    case GL_TEXTURE_CUBE_MAP: return 1;
+    case GL_TEXTURE_3D: return 2;
+    case GL_TEXTURE_2D_ARRAY: return 3;
+    default: return -1;
+    }
+}
+
+static int
+CapabilityIndex(GLenum capability) {
+    switch(capability) {
+    case GL_DEPTH_TEST: return 0;
+    case GL_CULL_FACE: return 1;
+    case GL_BLEND: return 2;
+    case GL_SCISSOR_TEST: return 3;
+    case GL_STENCIL_TEST: return 4;
+    case GL_POLYGON_OFFSET_FILL: return 5;
+    default: return -1;
+    }
+}
+
+void
+StateUseProgram(unsigned program) {
+    if(StateChanged(&sState.Program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void
+StateBindVertexArray(unsigned vao) {
+    if(StateChanged(&sState.VAO, vao)) {
+        glBindVertexArray(vao);
+        sState.ElementBuffer = STATE_UNKNOWN;
+    }
+}
+
+void
+StateBindBuffer(GLenum target, unsigned buffer) {
+    unsigned* Slot = BufferSlot(target);
+    if(!Slot || StateChanged(Slot, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void
+StateForceBindBuffer(GLenum target, unsigned buffer) {
+    unsigned* Slot = BufferSlot(target);
+    if(Slot) {
+        *Slot = STATE_UNKNOWN;
+    }
+    StateBindBuffer(target, buffer);
+}
+
+void
+StateBindBufferBase(GLenum target, unsigned index, unsigned buffer) {
+    if(target != GL_UNIFORM_BUFFER || index >= STATE_MAX_UNIFORM_BINDINGS) {
+        glBindBufferBase(target, index, buffer);
+        return;
+    }
+    // NOTE(Jovan): Indexed bind also replaces the generic binding of the target
+    if(StateChanged(&sState.UniformBindings[index], buffer)) {
+        glBindBufferBase(target, index, buffer);
+        sState.UniformBuffer = buffer;
+    }
+}
+
+void
+StateBindTexture(unsigned unit, GLenum target, unsigned texture) {
+    int TargetIdx = TextureTargetIndex(target);
+    if(TargetIdx < 0 || unit >= STATE_MAX_TEXTURE_UNITS) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        if(sState.Initialized) {
+            sState.ActiveTexture = unit;
+        }
+        return;
+    }
+    if(!StateChanged(&sState.Textures[unit][TargetIdx], texture)) {
+        return;
+    }
+    // NOTE(Jovan): Unit is only switched for binds that reach GL, so it isn't counted as elided otherwise
+    if(sState.ActiveTexture != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        sState.ActiveTexture = unit;
+        ++sState.Stats.Issued;
+    }
+    glBindTexture(target, texture);
+}
+
+static void
+SetCapability(GLenum capability, unsigned enabled) {
+    int CapabilityIdx = CapabilityIndex(capability);
+    if(CapabilityIdx < 0 || StateChanged(&sState.Capabilities[CapabilityIdx], enabled)) {
+        if(enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+    }
+}
+
+void
+StateEnable(GLenum capability) {
+    SetCapability(capability, 1);
+}
+
+void
+StateDisable(GLenum capability) {
+    SetCapability(capability, 0);
+}
+
+void
+StateDepthFunc(GLenum func) {
+    if(StateChanged(&sState.DepthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void
+StateDepthMask(GLboolean enabled) {
+    if(StateChanged(&sState.DepthMask, enabled)) {
+        glDepthMask(enabled);
+    }
+}
+
+void
+StateCullFace(GLenum mode) {
+    if(StateChanged(&sState.CullFace, mode)) {
+        glCullFace(mode);
+    }
+}
+
+void
+StateDeleteProgram(unsigned program) {
+    // NOTE(Jovan): Current program stays in use until replaced, yet its name may already be reused
+    if(sState.Initialized && sState.Program == program) {
+        sState.Program = STATE_UNKNOWN;
+    }
+    glDeleteProgram(program);
+}
+
+void
+StateDeleteVertexArrays(GLsizei count, const unsigned* vaos) {
+    for(GLsizei VaoIdx = 0; sState.Initialized && VaoIdx < count; ++VaoIdx) {
+        if(vaos[VaoIdx] && sState.VAO == vaos[VaoIdx]) {
+            sState.VAO = 0;
+            sState.ElementBuffer = STATE_UNKNOWN;
+        }
+    }
+    glDeleteVertexArrays(count, vaos);
+}
+
+void
+StateDeleteBuffers(GLsizei count, const unsigned* buffers) {
+    for(GLsizei BufferIdx = 0; sState.Initialized && BufferIdx < count; ++BufferIdx) {
+        unsigned Buffer = buffers[BufferIdx];
+        if(!Buffer) {
+            continue;
+        }
+        sState.ArrayBuffer = sState.ArrayBuffer == Buffer ? 0 : sState.ArrayBuffer;
+        sState.ElementBuffer = sState.ElementBuffer == Buffer ? 0 : sState.ElementBuffer;
+        sState.UniformBuffer = sState.UniformBuffer == Buffer ? 0 : sState.UniformBuffer;
+        for(unsigned Binding = 0; Binding < STATE_MAX_UNIFORM_BINDINGS; ++Binding) {
+            sState.UniformBindings[Binding] = sState.UniformBindings[Binding] == Buffer ? 0 : sState.UniformBindings[Binding];
+        }
+    }
+    glDeleteBuffers(count, buffers);
+}
+
+void
+StateDeleteTextures(GLsizei count, const unsigned* textures) {
+    for(GLsizei TextureIdx = 0; sState.Initialized && TextureIdx < count; ++TextureIdx) {
+        if(!textures[TextureIdx]) {
+            continue;
+        }
+        for(unsigned Unit = 0; Unit < STATE_MAX_TEXTURE_UNITS; ++Unit) {
+            for(unsigned TargetIdx = 0; TargetIdx < STATE_NUM_TEXTURE_TARGETS; ++TargetIdx) {
+                if(sState.Textures[Unit][TargetIdx] == textures[TextureIdx]) {
+                    sState.Textures[Unit][TargetIdx] = 0;
+                }
+            }
+        }
+    }
+    glDeleteTextures(count, textures);
+}
+
+GlStateStats
+StateGetStats(void) {
+    return sState.Stats;
+}
+
+void
+StateResetStats(void) {
+    sState.Stats.Issued = 0;
+    sState.Stats.Elided = 0;
+}
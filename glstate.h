@@ -0,0 +1,84 @@
+/**
+ * @file glstate.h
+ * @author Jovan Ivosevic
+ * @brief Shadow copy of render context binding state that skips GL calls which would change nothing
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+// NOTE(Jovan): Cached state unknown to the cache, the next call always reaches GL
+#define STATE_UNKNOWN 0xFFFFFFFFu
+#define STATE_MAX_UNIFORM_BINDINGS 16
+#define STATE_MAX_TEXTURE_UNITS 16
+
+#include <stdint.h>
+#include <GL/glew.h>
+
+/**
+ * @brief Number of state calls passed on to GL and skipped as redundant since the last reset
+ *
+ */
+typedef struct GlStateStats {
+    uint64_t Issued;
+    uint64_t Elided;
+} GlStateStats;
+
+/**
+ * @brief Cached replacements of GL state calls. Only the render context is tracked, so these must
+ *        not be used on the upload context and GL state must not be changed behind their back
+ *        on the render context, or StateInvalidate has to be called afterwards.
+ *        Buffer targets, texture targets and capabilities the cache doesn't know are passed through.
+ *
+ */
+void StateUseProgram(unsigned program);
+void StateBindVertexArray(unsigned vao);
+void StateBindBuffer(GLenum target, unsigned buffer);
+void StateBindBufferBase(GLenum target, unsigned index, unsigned buffer);
+void StateBindTexture(unsigned unit, GLenum target, unsigned texture);
+void StateEnable(GLenum capability);
+void StateDisable(GLenum capability);
+void StateDepthFunc(GLenum func);
+void StateDepthMask(GLboolean enabled);
+void StateCullFace(GLenum mode);
+
+/**
+ * @brief Binds buffer even if the cache already has it bound. Contents written by another context are only
+ *        guaranteed visible after the writes are fenced and the buffer is bound again on this context.
+ *
+ */
+void StateForceBindBuffer(GLenum target, unsigned buffer);
+
+/**
+ * @brief Deletes objects and forgets them, GL unbinds deleted objects and may hand out their names again
+ *
+ */
+void StateDeleteProgram(unsigned program);
+void StateDeleteVertexArrays(GLsizei count, const unsigned* vaos);
+void StateDeleteBuffers(GLsizei count, const unsigned* buffers);
+void StateDeleteTextures(GLsizei count, const unsigned* textures);
+
+/**
+ * @brief Forgets all cached state, e.g. after code issued GL state calls directly
+ *
+ */
+void StateInvalidate(void);
+
+/**
+ * @brief Returns call counters
+ *
+ */
+GlStateStats StateGetStats(void);
+
+/**
+ * @brief Zeroes call counters
+ *
+ */
+void StateResetStats(void);
+
+#endif
@@ -0,0 +1,92 @@
+#include "hash.h"
+
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static uint64_t
+RotateLeft(uint64_t value, unsigned bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t
+Read64(const unsigned char* p) {
+    uint64_t Value;
+    memcpy(&Value, p, sizeof(Value));
+    return Value;
+}
+
+static uint32_t
+Read32(const unsigned char* p) {
+    uint32_t Value;
+    memcpy(&Value, p, sizeof(Value));
+    return Value;
+}
+
+static uint64_t
+Round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME64_2;
+    accumulator = RotateLeft(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+static uint64_t
+MergeRound(uint64_t accumulator, uint64_t value) {
+    accumulator ^= Round(0, value);
+    return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t
+HashBytes(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* End = p + size;
+    uint64_t Hash;
+
+    if(size >= 32) {
+        // NOTE(Jovan): Four independent lanes keep the multipliers busy on large inputs
+        uint64_t Lanes[4] = { seed + PRIME64_1 + PRIME64_2, seed + PRIME64_2, seed, seed - PRIME64_1 };
+        const unsigned char* Limit = End - 32;
+        do {
+            Lanes[0] = Round(Lanes[0], Read64(p));
+            Lanes[1] = Round(Lanes[1], Read64(p + 8));
+            Lanes[2] = Round(Lanes[2], Read64(p + 16));
+            Lanes[3] = Round(Lanes[3], Read64(p + 24));
+            p += 32;
+        } while(p <= Limit);
+
+        Hash = RotateLeft(Lanes[0], 1) + RotateLeft(Lanes[1], 7) + RotateLeft(Lanes[2], 12) + RotateLeft(Lanes[3], 18);
+        for(unsigned LaneIdx = 0; LaneIdx < 4; ++LaneIdx) {
+            Hash = MergeRound(Hash, Lanes[LaneIdx]);
+        }
+    } else {
+        Hash = seed + PRIME64_5;
+    }
+
+    Hash += (uint64_t)size;
+    for(; p + 8 <= End; p += 8) {
+        Hash ^= Round(0, Read64(p));
+        Hash = RotateLeft(Hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+
+    if(p + 4 <= End) {
+        Hash ^= (uint64_t)Read32(p) * PRIME64_1;
+        Hash = RotateLeft(Hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+
+    for(; p < End; ++p) {
+        Hash ^= (*p) * PRIME64_5;
+        Hash = RotateLeft(Hash, 11) * PRIME64_1;
+    }
+
+    Hash ^= Hash >> 33;
+    Hash *= PRIME64_2;
+    Hash ^= Hash >> 29;
+    Hash *= PRIME64_3;
+    Hash ^= Hash >> 32;
+    return Hash;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file hash.h
+ * @author Jovan Ivosevic
+ * @brief Non-cryptographic 64-bit hashing (XXH64)
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Hashes byte range with XXH64
+ *
+ * @param data Bytes to hash
+ * @param size Number of bytes
+ * @param seed Hash seed
+ * @return uint64_t Hash value
+ */
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed);
+
+#endif
@@ -0,0 +1,146 @@
+#include "instancing.h"
+#include "shader.h"
+#include "glstate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int
+InitInstanceBatch(InstanceBatch* batch, unsigned vao, GLenum mode, unsigned count) {
+    memset(batch, 0, sizeof(InstanceBatch));
+    batch->VAO = vao;
+    batch->Mode = mode;
+    batch->Count = count;
+
+    glGenBuffers(1, &batch->InstanceVBO);
+    if(!batch->InstanceVBO) {
+        fprintf(stderr, "Failed to create instance buffer.\n");
+        return INSTANCING_FAIL;
+    }
+
+    // NOTE(Jovan): Attribute pointers are VAO state, the buffer itself is sized on the first draw
+    StateBindVertexArray(vao);
+    StateBindBuffer(GL_ARRAY_BUFFER, batch->InstanceVBO);
+    for(unsigned Column = 0; Column < 4; ++Column) {
+        GLuint Location = LAYOUT_INSTANCE_MODEL + Column;
+        glVertexAttribPointer(Location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void*)(offsetof(InstanceData, Model) + Column * 4 * sizeof(float)));
+        glVertexAttribDivisor(Location, 1);
+        glEnableVertexAttribArray(Location);
+    }
+    glVertexAttribPointer(LAYOUT_INSTANCE_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, Color));
+    glVertexAttribDivisor(LAYOUT_INSTANCE_COLOR, 1);
+    glEnableVertexAttribArray(LAYOUT_INSTANCE_COLOR);
+    StateBindVertexArray(0);
+    return INSTANCING_SUCCESS;
+}
+
+int
+CreateInstanceBatch(InstanceBatch* batch, unsigned vao, GLenum mode, unsigned first, unsigned count) {
+    if(!InitInstanceBatch(batch, vao, mode, count)) {
+        return INSTANCING_FAIL;
+    }
+    batch->First = first;
+    return INSTANCING_SUCCESS;
+}
+
+int
+CreateIndexedInstanceBatch(InstanceBatch* batch, unsigned vao, GLenum mode, unsigned count, GLenum indexType,
+                           size_t indexOffset) {
+    if(!InitInstanceBatch(batch, vao, mode, count)) {
+        return INSTANCING_FAIL;
+    }
+    batch->IndexType = indexType;
+    batch->IndexOffset = indexOffset;
+    return INSTANCING_SUCCESS;
+}
+
+static void
+WriteInstance(InstanceData* instance, mat4 model, const float* color) {
+    memcpy(instance->Model, model, sizeof(instance->Model));
+    if(color) {
+        memcpy(instance->Color, color, sizeof(instance->Color));
+    } else {
+        instance->Color[0] = instance->Color[1] = instance->Color[2] = instance->Color[3] = 1.0f;
+    }
+}
+
+int
+PushInstance(InstanceBatch* batch, mat4 model, const float* color) {
+    if(batch->NumInstances == batch->Capacity) {
+        unsigned Capacity = batch->Capacity ? 2 * batch->Capacity : 16;
+        InstanceData* Instances = (InstanceData*)realloc(batch->Instances, Capacity * sizeof(InstanceData));
+        if(!Instances) {
+            fprintf(stderr, "Failed to allocate instances.\n");
+            return INSTANCING_FAIL;
+        }
+        batch->Instances = Instances;
+        batch->Capacity = Capacity;
+    }
+
+    WriteInstance(&batch->Instances[batch->NumInstances++], model, color);
+    batch->Dirty = 1;
+    return INSTANCING_SUCCESS;
+}
+
+int
+SetInstance(InstanceBatch* batch, unsigned instanceIdx, mat4 model, const float* color) {
+    if(instanceIdx >= batch->NumInstances) {
+        return INSTANCING_FAIL;
+    }
+
+    WriteInstance(&batch->Instances[instanceIdx], model, color);
+    batch->Dirty = 1;
+    return INSTANCING_SUCCESS;
+}
+
+void
+ClearInstances(InstanceBatch* batch) {
+    batch->NumInstances = 0;
+    batch->Dirty = 1;
+}
+
+static void
+UploadInstances(InstanceBatch* batch) {
+    GLsizeiptr Size = (GLsizeiptr)batch->NumInstances * sizeof(InstanceData);
+    StateBindBuffer(GL_ARRAY_BUFFER, batch->InstanceVBO);
+    // NOTE(Jovan): Storage is respecified before every upload so the driver can hand out fresh memory
+    // instead of waiting for draws still reading the previous instances
+    if(batch->NumInstances > batch->BufferCapacity) {
+        batch->BufferCapacity = batch->Capacity;
+    }
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)batch->BufferCapacity * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, Size, batch->Instances);
+    batch->Dirty = 0;
+}
+
+void
+DrawInstances(InstanceBatch* batch) {
+    if(!batch->NumInstances) {
+        return;
+    }
+    if(batch->Dirty) {
+        UploadInstances(batch);
+    }
+
+    GLint InstancedLocation = GetUniformLocation(GetCurrentShaderProgram(), "uInstanced");
+    glUniform1i(InstancedLocation, 1);
+    StateBindVertexArray(batch->VAO);
+    if(batch->IndexType) {
+        glDrawElementsInstanced(batch->Mode, (GLsizei)batch->Count, batch->IndexType, (const void*)batch->IndexOffset,
+                                (GLsizei)batch->NumInstances);
+    } else {
+        glDrawArraysInstanced(batch->Mode, (GLint)batch->First, (GLsizei)batch->Count, (GLsizei)batch->NumInstances);
+    }
+    glUniform1i(InstancedLocation, 0);
+}
+
+void
+FreeInstanceBatch(InstanceBatch* batch) {
+    if(batch->InstanceVBO) {
+        StateDeleteBuffers(1, &batch->InstanceVBO);
+    }
+    free(batch->Instances);
+    memset(batch, 0, sizeof(InstanceBatch));
+}
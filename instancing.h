@@ -0,0 +1,126 @@
+/**
+ * @file instancing.h
+ * @author Jovan Ivosevic
+ * @brief Hardware instanced drawing of one mesh placed many times with per-instance transforms
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#define INSTANCING_SUCCESS 1
+#define INSTANCING_FAIL 0
+// NOTE(Jovan): Must match shaders/basic.vert. Model matrix takes one location per column, 4 through 7.
+#define LAYOUT_INSTANCE_MODEL 4
+#define LAYOUT_INSTANCE_COLOR 8
+
+#include <stddef.h>
+#include <GL/glew.h>
+#include "cglm/cglm.h"
+
+/**
+ * @brief Per-instance attributes as laid out in the instance buffer. Color multiplies vertex or material color.
+ *
+ */
+typedef struct InstanceData {
+    float Model[16];
+    float Color[4];
+} InstanceData;
+
+/**
+ * @brief One mesh and the instances it's drawn at. Instances are kept on the CPU and uploaded
+ *        on the next draw after they change, so static instances cost nothing per frame.
+ *
+ */
+typedef struct InstanceBatch {
+    unsigned VAO;
+    unsigned InstanceVBO;
+    GLenum Mode;
+    unsigned First;
+    unsigned Count;
+    // NOTE(Jovan): Zero for meshes drawn from vertex arrays alone
+    GLenum IndexType;
+    size_t IndexOffset;
+    unsigned NumInstances;
+    unsigned Capacity;
+    unsigned BufferCapacity;
+    int Dirty;
+    InstanceData* Instances;
+} InstanceBatch;
+
+/**
+ * @brief Registers non-indexed mesh for instancing. Instance attributes are added to the mesh VAO,
+ *        which then should not be drawn without instancing, per-vertex attributes are left as they are.
+ *
+ * @param batch Batch struct which will contain result
+ * @param vao Mesh VAO with per-vertex attributes set up
+ * @param mode Primitive type, e.g. GL_TRIANGLES
+ * @param first First vertex
+ * @param count Number of vertices
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int CreateInstanceBatch(InstanceBatch* batch, unsigned vao, GLenum mode, unsigned first, unsigned count);
+
+/**
+ * @brief Registers indexed mesh for instancing, element buffer must be bound to the VAO
+ *
+ * @param batch Batch struct which will contain result
+ * @param vao Mesh VAO with per-vertex attributes and element buffer set up
+ * @param mode Primitive type, e.g. GL_TRIANGLES
+ * @param count Number of indices
+ * @param indexType GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+ * @param indexOffset Byte offset of the first index in the element buffer
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int CreateIndexedInstanceBatch(InstanceBatch* batch, unsigned vao, GLenum mode, unsigned count, GLenum indexType,
+                               size_t indexOffset);
+
+/**
+ * @brief Appends instance
+ *
+ * @param batch Batch
+ * @param model Model to world transform
+ * @param color RGBA multiplied into the mesh color, NULL leaves it unchanged
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int PushInstance(InstanceBatch* batch, mat4 model, const float* color);
+
+/**
+ * @brief Replaces transform and color of an existing instance, e.g. of a moving object
+ *
+ * @param batch Batch
+ * @param instanceIdx Index of instance in push order
+ * @param model Model to world transform
+ * @param color RGBA multiplied into the mesh color, NULL leaves it unchanged
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SetInstance(InstanceBatch* batch, unsigned instanceIdx, mat4 model, const float* color);
+
+/**
+ * @brief Removes all instances, keeping allocated memory for the next frame
+ *
+ * @param batch Batch
+ */
+void ClearInstances(InstanceBatch* batch);
+
+/**
+ * @brief Draws all instances with one instanced draw call using the program set with UseShaderProgram.
+ *        Sets uInstanced of the program for the draw, uModel is ignored while it's set.
+ *
+ * @param batch Batch
+ */
+void DrawInstances(InstanceBatch* batch);
+
+/**
+ * @brief Frees instance buffer and instances. Mesh VAO is owned by the caller and left alive.
+ *        Does not free batch struct itself.
+ *
+ * @param batch Batch
+ */
+void FreeInstanceBatch(InstanceBatch* batch);
+
+#endif
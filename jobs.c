@@ -0,0 +1,293 @@
+#include "jobs.h"
+#include "platform.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct JobSystem {
+    Thread** Workers;
+    unsigned NumWorkers;
+    Mutex* Lock;
+    CondVar* HasWork;
+    Job* Head;
+    Job* Tail;
+    // NOTE(Jovan): Continuations waiting for the main thread, which owns the GL context
+    CondVar* HasMainWork;
+    Job* MainHead;
+    Job* MainTail;
+    int Quit;
+} JobSystem;
+
+typedef struct ParallelForContext {
+    ParallelForFunc Func;
+    void* Data;
+    long Count;
+    volatile long Next;
+    volatile long Done;
+    // NOTE(Jovan): Helper jobs can start after the loop is finished, last reference frees context
+    volatile long References;
+    Mutex* Lock;
+    CondVar* Finished;
+} ParallelForContext;
+
+static JobSystem sJobs;
+
+static int
+WorkerMain(void* arg) {
+    (void)arg;
+    for(;;) {
+        MutexLock(sJobs.Lock);
+        while(!sJobs.Head && !sJobs.Quit) {
+            CondVarWait(sJobs.HasWork, sJobs.Lock);
+        }
+
+        if(!sJobs.Head) {
+            MutexUnlock(sJobs.Lock);
+            break;
+        }
+
+        Job* CurrJob = sJobs.Head;
+        sJobs.Head = CurrJob->Next;
+        if(!sJobs.Head) {
+            sJobs.Tail = NULL;
+        }
+        MutexUnlock(sJobs.Lock);
+
+        CurrJob->Func(CurrJob->Data);
+        free(CurrJob);
+    }
+
+    return 0;
+}
+
+int
+JobSystemInit(unsigned numWorkers) {
+    if(sJobs.NumWorkers) {
+        return JOBS_SUCCESS;
+    }
+
+    if(!numWorkers) {
+        unsigned CpuCount = PlatformCpuCount();
+        numWorkers = CpuCount > 1 ? CpuCount - 1 : 1;
+    }
+
+    sJobs.Lock = MutexCreate();
+    sJobs.HasWork = CondVarCreate();
+    sJobs.HasMainWork = CondVarCreate();
+    sJobs.Workers = (Thread**)calloc(numWorkers, sizeof(Thread*));
+    if(!sJobs.Lock || !sJobs.HasWork || !sJobs.HasMainWork || !sJobs.Workers) {
+        fprintf(stderr, "Failed to allocate job system.\n");
+        JobSystemShutdown();
+        return JOBS_FAIL;
+    }
+
+    sJobs.Quit = 0;
+    for(unsigned WorkerIdx = 0; WorkerIdx < numWorkers; ++WorkerIdx) {
+        sJobs.Workers[WorkerIdx] = ThreadCreate(WorkerMain, NULL);
+        if(!sJobs.Workers[WorkerIdx]) {
+            fprintf(stderr, "Failed to start worker thread.\n");
+            break;
+        }
+        ++sJobs.NumWorkers;
+    }
+
+    if(!sJobs.NumWorkers) {
+        JobSystemShutdown();
+        return JOBS_FAIL;
+    }
+
+    return JOBS_SUCCESS;
+}
+
+void
+JobSystemShutdown(void) {
+    if(sJobs.Lock) {
+        MutexLock(sJobs.Lock);
+        sJobs.Quit = 1;
+        if(sJobs.HasWork) {
+            CondVarBroadcast(sJobs.HasWork);
+        }
+        MutexUnlock(sJobs.Lock);
+    }
+
+    for(unsigned WorkerIdx = 0; WorkerIdx < sJobs.NumWorkers; ++WorkerIdx) {
+        ThreadJoin(sJobs.Workers[WorkerIdx]);
+    }
+
+    // NOTE(Jovan): Finished jobs may have left continuations behind, workers are gone so no new ones arrive
+    while(sJobs.MainHead) {
+        Job* CurrJob = sJobs.MainHead;
+        sJobs.MainHead = CurrJob->Next;
+        CurrJob->Func(CurrJob->Data);
+    }
+
+    free(sJobs.Workers);
+    if(sJobs.HasWork) {
+        CondVarDestroy(sJobs.HasWork);
+    }
+    if(sJobs.HasMainWork) {
+        CondVarDestroy(sJobs.HasMainWork);
+    }
+    if(sJobs.Lock) {
+        MutexDestroy(sJobs.Lock);
+    }
+    memset(&sJobs, 0, sizeof(JobSystem));
+}
+
+unsigned
+JobWorkerCount(void) {
+    return sJobs.NumWorkers;
+}
+
+void
+JobSubmit(JobFunc func, void* data) {
+    Job* NewJob = sJobs.NumWorkers ? (Job*)malloc(sizeof(Job)) : NULL;
+    if(!NewJob) {
+        func(data);
+        return;
+    }
+
+    NewJob->Func = func;
+    NewJob->Data = data;
+    NewJob->Next = NULL;
+
+    MutexLock(sJobs.Lock);
+    if(sJobs.Tail) {
+        sJobs.Tail->Next = NewJob;
+    } else {
+        sJobs.Head = NewJob;
+    }
+    sJobs.Tail = NewJob;
+    CondVarSignal(sJobs.HasWork);
+    MutexUnlock(sJobs.Lock);
+}
+
+void
+JobSubmitMain(Job* job, JobFunc func, void* data) {
+    if(!sJobs.NumWorkers) {
+        func(data);
+        return;
+    }
+
+    job->Func = func;
+    job->Data = data;
+    job->Next = NULL;
+
+    MutexLock(sJobs.Lock);
+    if(sJobs.MainTail) {
+        sJobs.MainTail->Next = job;
+    } else {
+        sJobs.MainHead = job;
+    }
+    sJobs.MainTail = job;
+    CondVarSignal(sJobs.HasMainWork);
+    MutexUnlock(sJobs.Lock);
+}
+
+unsigned
+JobRunMain(int wait) {
+    if(!sJobs.NumWorkers) {
+        return 0;
+    }
+
+    MutexLock(sJobs.Lock);
+    while(wait && !sJobs.MainHead) {
+        CondVarWait(sJobs.HasMainWork, sJobs.Lock);
+    }
+    // NOTE(Jovan): Whole queue is taken at once, continuations queued while these run wait for the next call
+    Job* CurrJob = sJobs.MainHead;
+    sJobs.MainHead = NULL;
+    sJobs.MainTail = NULL;
+    MutexUnlock(sJobs.Lock);
+
+    unsigned NumRun = 0;
+    while(CurrJob) {
+        // NOTE(Jovan): Nodes belong to the job data, which the job may free
+        Job* Next = CurrJob->Next;
+        CurrJob->Func(CurrJob->Data);
+        CurrJob = Next;
+        ++NumRun;
+    }
+    return NumRun;
+}
+
+static void
+ReleaseParallelFor(ParallelForContext* context) {
+    if(AtomicDecrement(&context->References)) {
+        return;
+    }
+
+    CondVarDestroy(context->Finished);
+    MutexDestroy(context->Lock);
+    free(context);
+}
+
+static void
+RunParallelFor(void* data) {
+    ParallelForContext* Context = (ParallelForContext*)data;
+    for(;;) {
+        long Index = AtomicIncrement(&Context->Next) - 1;
+        if(Index >= Context->Count) {
+            break;
+        }
+
+        Context->Func(Context->Data, (unsigned)Index);
+        if(AtomicIncrement(&Context->Done) == Context->Count) {
+            MutexLock(Context->Lock);
+            CondVarBroadcast(Context->Finished);
+            MutexUnlock(Context->Lock);
+        }
+    }
+
+    ReleaseParallelFor(Context);
+}
+
+void
+JobParallelFor(unsigned count, ParallelForFunc func, void* data) {
+    if(!count) {
+        return;
+    }
+
+    ParallelForContext* Context = NULL;
+    if(sJobs.NumWorkers && count > 1) {
+        Context = (ParallelForContext*)calloc(1, sizeof(ParallelForContext));
+    }
+
+    if(Context) {
+        Context->Lock = MutexCreate();
+        Context->Finished = CondVarCreate();
+        if(!Context->Lock || !Context->Finished) {
+            if(Context->Lock) MutexDestroy(Context->Lock);
+            if(Context->Finished) CondVarDestroy(Context->Finished);
+            free(Context);
+            Context = NULL;
+        }
+    }
+
+    if(!Context) {
+        for(unsigned Index = 0; Index < count; ++Index) {
+            func(data, Index);
+        }
+        return;
+    }
+
+    unsigned NumHelpers = count - 1 < sJobs.NumWorkers ? count - 1 : sJobs.NumWorkers;
+    Context->Func = func;
+    Context->Data = data;
+    Context->Count = (long)count;
+    // NOTE(Jovan): One reference per helper, one for the caller and one for the final wait
+    Context->References = (long)NumHelpers + 2;
+    for(unsigned HelperIdx = 0; HelperIdx < NumHelpers; ++HelperIdx) {
+        JobSubmit(RunParallelFor, Context);
+    }
+
+    RunParallelFor(Context);
+
+    MutexLock(Context->Lock);
+    while(AtomicLoad(&Context->Done) < Context->Count) {
+        CondVarWait(Context->Finished, Context->Lock);
+    }
+    MutexUnlock(Context->Lock);
+    ReleaseParallelFor(Context);
+}
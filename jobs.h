@@ -0,0 +1,89 @@
+/**
+ * @file jobs.h
+ * @author Jovan Ivosevic
+ * @brief Fixed size worker thread pool
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#define JOBS_SUCCESS 1
+#define JOBS_FAIL 0
+
+typedef void (*JobFunc)(void* data);
+typedef void (*ParallelForFunc)(void* data, unsigned index);
+
+/**
+ * @brief Queued job. Main thread jobs use a node embedded in their data by the caller, so handing
+ *        work over to the main thread never allocates and can't fail.
+ *
+ */
+typedef struct Job {
+    JobFunc Func;
+    void* Data;
+    struct Job* Next;
+} Job;
+
+/**
+ * @brief Starts worker threads. Until this is called all work runs on the calling thread.
+ *
+ * @param numWorkers Number of workers, 0 - one less than the number of logical processors
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int JobSystemInit(unsigned numWorkers);
+
+/**
+ * @brief Finishes queued jobs and joins all workers
+ *
+ */
+void JobSystemShutdown(void);
+
+/**
+ * @brief Returns number of running worker threads
+ *
+ */
+unsigned JobWorkerCount(void);
+
+/**
+ * @brief Queues func(data) for execution on a worker thread. Runs it inline if there are no workers.
+ *
+ * @param func Job function
+ * @param data Job argument
+ */
+void JobSubmit(JobFunc func, void* data);
+
+/**
+ * @brief Queues func(data) for the main thread, which owns the GL context. Lets a job hand its
+ *        GL work over once the data is ready. Runs it inline if there are no workers, then the
+ *        submitting job itself runs on the main thread.
+ *
+ * @param job Queue node, usually embedded in data. Must stay valid until func is called, func may free it.
+ * @param func Job function
+ * @param data Job argument
+ */
+void JobSubmitMain(Job* job, JobFunc func, void* data);
+
+/**
+ * @brief Runs jobs queued for the main thread. Call from the main thread only.
+ *
+ * @param wait Nonzero blocks until at least one job is queued, the caller has to know one is coming
+ * @return unsigned Number of jobs run
+ */
+unsigned JobRunMain(int wait);
+
+/**
+ * @brief Calls func(data, i) for every i in [0, count) and waits for all of them to finish.
+ *        The calling thread takes part in the work, so it is safe to call from within a job.
+ *
+ * @param count Number of iterations
+ * @param func Iteration function
+ * @param data Iteration argument
+ */
+void JobParallelFor(unsigned count, ParallelForFunc func, void* data);
+
+#endif
@@ -0,0 +1,121 @@
+#include "loadprofile.h"
+#include "platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* sStageNames[PROFILE_STAGE_COUNT] = {
+    "file_read",
+    "import",
+    "process",
+    "vertex_conversion",
+    "index_build",
+    "cache_write",
+    "upload",
+    "teardown"
+};
+
+uint64_t
+ProfileStart(void) {
+    return PlatformTimerTicks();
+}
+
+double
+ProfileElapsed(uint64_t start) {
+    return (double)(PlatformTimerTicks() - start) / (double)PlatformTimerFrequency();
+}
+
+void
+ProfileAddStage(LoadProfile* profile, unsigned stage, double seconds, uint64_t bytes) {
+    if(!profile || stage >= PROFILE_STAGE_COUNT) {
+        return;
+    }
+
+    profile->Stages[stage].Seconds += seconds;
+    profile->Stages[stage].Bytes += bytes;
+    profile->TotalSeconds += seconds;
+}
+
+void
+ProfileAddMeshStage(LoadProfile* profile, unsigned meshIdx, unsigned stage, double seconds, uint64_t bytes) {
+    if(!profile || meshIdx >= profile->NumMeshes || stage >= PROFILE_STAGE_COUNT) {
+        return;
+    }
+
+    profile->Meshes[meshIdx].Stages[stage].Seconds += seconds;
+    profile->Meshes[meshIdx].Stages[stage].Bytes += bytes;
+}
+
+int
+ProfileSetMeshCount(LoadProfile* profile, unsigned numMeshes) {
+    if(!profile) {
+        return 1;
+    }
+
+    free(profile->Meshes);
+    profile->Meshes = NULL;
+    profile->NumMeshes = 0;
+    if(!numMeshes) {
+        return 1;
+    }
+
+    profile->Meshes = (MeshLoadProfile*)calloc(numMeshes, sizeof(MeshLoadProfile));
+    if(!profile->Meshes) {
+        fprintf(stderr, "Failed to allocate load profile.\n");
+        return 0;
+    }
+    profile->NumMeshes = numMeshes;
+    return 1;
+}
+
+const char*
+ProfileStageName(unsigned stage) {
+    return stage < PROFILE_STAGE_COUNT ? sStageNames[stage] : "unknown";
+}
+
+static void
+WriteJsonString(const char* value, FILE* file) {
+    fputc('"', file);
+    for(const unsigned char* Curr = (const unsigned char*)value; *Curr; ++Curr) {
+        if(*Curr == '"' || *Curr == '\\') {
+            fprintf(file, "\\%c", *Curr);
+        } else if(*Curr < 0x20) {
+            fprintf(file, "\\u%04x", *Curr);
+        } else {
+            fputc(*Curr, file);
+        }
+    }
+    fputc('"', file);
+}
+
+static void
+WriteJsonStages(const StageProfile* stages, FILE* file) {
+    fputc('{', file);
+    for(unsigned Stage = 0; Stage < PROFILE_STAGE_COUNT; ++Stage) {
+        fprintf(file, "%s\"%s\":{\"ms\":%.3f,\"bytes\":%llu}", Stage ? "," : "", sStageNames[Stage],
+                stages[Stage].Seconds * 1000.0, (unsigned long long)stages[Stage].Bytes);
+    }
+    fputc('}', file);
+}
+
+int
+WriteLoadProfileJson(const LoadProfile* profile, const char* filePath, FILE* file) {
+    fputs("{\"model\":", file);
+    WriteJsonString(filePath, file);
+    fprintf(file, ",\"from_cache\":%s,\"total_ms\":%.3f,\"stages\":", profile->FromCache ? "true" : "false",
+            profile->TotalSeconds * 1000.0);
+    WriteJsonStages(profile->Stages, file);
+    fputs(",\"meshes\":[", file);
+    for(unsigned MeshIdx = 0; MeshIdx < profile->NumMeshes; ++MeshIdx) {
+        fputs(MeshIdx ? "," : "", file);
+        WriteJsonStages(profile->Meshes[MeshIdx].Stages, file);
+    }
+    fputs("]}\n", file);
+    return ferror(file) ? 0 : 1;
+}
+
+void
+FreeLoadProfile(LoadProfile* profile) {
+    free(profile->Meshes);
+    memset(profile, 0, sizeof(LoadProfile));
+}
@@ -0,0 +1,124 @@
+/**
+ * @file loadprofile.h
+ * @author Jovan Ivosevic
+ * @brief Per-stage timers and byte counters of model loading
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LOADPROFILE_H
+#define LOADPROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// NOTE(Jovan): Mesh cache probe and mapping. Source files are read while they are parsed, so that time counts as import.
+#define PROFILE_STAGE_FILE_READ 0
+#define PROFILE_STAGE_IMPORT 1
+#define PROFILE_STAGE_PROCESS 2
+#define PROFILE_STAGE_VERTEX_CONVERSION 3
+#define PROFILE_STAGE_INDEX_BUILD 4
+#define PROFILE_STAGE_CACHE_WRITE 5
+#define PROFILE_STAGE_UPLOAD 6
+#define PROFILE_STAGE_TEARDOWN 7
+#define PROFILE_STAGE_COUNT 8
+
+/**
+ * @brief Accumulated wall time and bytes produced, read or released by one stage
+ *
+ */
+typedef struct StageProfile {
+    double Seconds;
+    uint64_t Bytes;
+} StageProfile;
+
+typedef struct MeshLoadProfile {
+    StageProfile Stages[PROFILE_STAGE_COUNT];
+} MeshLoadProfile;
+
+/**
+ * @brief Load statistics of one model. Model stages are wall time of the whole stage, mesh stages
+ *        are time spent on that mesh alone, so with parallel stages the mesh times may add up to more.
+ *        Meshes are indexed like the meshes of the loaded model.
+ *
+ */
+typedef struct LoadProfile {
+    int FromCache;
+    double TotalSeconds;
+    StageProfile Stages[PROFILE_STAGE_COUNT];
+    unsigned NumMeshes;
+    MeshLoadProfile* Meshes;
+} LoadProfile;
+
+/**
+ * @brief Starts measuring a stage
+ *
+ * @return uint64_t Timer start, pass to ProfileElapsed
+ */
+uint64_t ProfileStart(void);
+
+/**
+ * @brief Returns seconds passed since start
+ *
+ * @param start Value returned by ProfileStart
+ */
+double ProfileElapsed(uint64_t start);
+
+/**
+ * @brief Adds time and bytes to a model stage. NULL profile is ignored, so callers need no checks.
+ *
+ * @param profile Profile or NULL
+ * @param stage PROFILE_STAGE_*
+ * @param seconds Time spent
+ * @param bytes Bytes handled
+ */
+void ProfileAddStage(LoadProfile* profile, unsigned stage, double seconds, uint64_t bytes);
+
+/**
+ * @brief Adds time and bytes to a mesh stage. NULL profile and meshes outside the profile are ignored.
+ *
+ * @param profile Profile or NULL
+ * @param meshIdx Mesh index
+ * @param stage PROFILE_STAGE_*
+ * @param seconds Time spent
+ * @param bytes Bytes handled
+ */
+void ProfileAddMeshStage(LoadProfile* profile, unsigned meshIdx, unsigned stage, double seconds, uint64_t bytes);
+
+/**
+ * @brief Sizes mesh table of the profile and clears it
+ *
+ * @param profile Profile or NULL
+ * @param numMeshes Number of meshes
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ProfileSetMeshCount(LoadProfile* profile, unsigned numMeshes);
+
+/**
+ * @brief Returns stage name as used in JSON output
+ *
+ * @param stage PROFILE_STAGE_*
+ */
+const char* ProfileStageName(unsigned stage);
+
+/**
+ * @brief Writes profile as a single JSON object, times in milliseconds
+ *
+ * @param profile Profile
+ * @param filePath Model path, stored in the output
+ * @param file Output stream
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int WriteLoadProfileJson(const LoadProfile* profile, const char* filePath, FILE* file);
+
+/**
+ * @brief Releases mesh table of the profile. Safe to call on zeroed struct.
+ *
+ * @param profile Profile
+ */
+void FreeLoadProfile(LoadProfile* profile);
+
+#endif
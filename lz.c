@@ -0,0 +1,181 @@
+#include "lz.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t
+Read32(const unsigned char* p) {
+    uint32_t Value;
+    memcpy(&Value, p, sizeof(Value));
+    return Value;
+}
+
+static uint32_t
+HashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * @brief Bytes needed to store length beyond its token nibble
+ *
+ */
+static size_t
+LengthBytes(size_t length) {
+    return length < 15 ? 0 : (length - 15) / 255 + 1;
+}
+
+static unsigned char*
+WriteLength(unsigned char* out, size_t length) {
+    for(length -= 15; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+/**
+ * @brief Writes literal run and, for nonzero matchLength, the match that follows it
+ *
+ * @return unsigned char* Output end, NULL if out of capacity
+ */
+static unsigned char*
+WriteSequence(unsigned char* out, const unsigned char* outEnd, const unsigned char* literals, size_t numLiterals,
+              size_t offset, size_t matchLength) {
+    size_t MatchCode = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+    size_t Needed = 1 + LengthBytes(numLiterals) + numLiterals + (matchLength ? 2 + LengthBytes(MatchCode) : 0);
+    if(Needed > (size_t)(outEnd - out)) {
+        return NULL;
+    }
+
+    unsigned char* Token = out++;
+    *Token = (unsigned char)((numLiterals < 15 ? numLiterals : 15) << 4);
+    if(numLiterals >= 15) {
+        out = WriteLength(out, numLiterals);
+    }
+    memcpy(out, literals, numLiterals);
+    out += numLiterals;
+    if(!matchLength) {
+        return out;
+    }
+
+    *out++ = (unsigned char)(offset & 0xFF);
+    *out++ = (unsigned char)(offset >> 8);
+    *Token |= (unsigned char)(MatchCode < 15 ? MatchCode : 15);
+    if(MatchCode >= 15) {
+        out = WriteLength(out, MatchCode);
+    }
+    return out;
+}
+
+size_t
+LzCompress(const void* source, size_t sourceSize, void* destination, size_t capacity) {
+    const unsigned char* In = (const unsigned char*)source;
+    unsigned char* Out = (unsigned char*)destination;
+    const unsigned char* OutEnd = Out + capacity;
+    // NOTE(Jovan): Positions are stored plus one, zero marks an empty slot
+    uint32_t Table[1 << LZ_HASH_BITS];
+    memset(Table, 0, sizeof(Table));
+
+    size_t Anchor = 0;
+    if(sourceSize > LZ_MATCH_MARGIN) {
+        size_t MatchEnd = sourceSize - LZ_LAST_LITERALS;
+        size_t SearchEnd = sourceSize - LZ_MATCH_MARGIN;
+        size_t Pos = 0;
+        while(Pos < SearchEnd) {
+            uint32_t Sequence = Read32(In + Pos);
+            uint32_t Slot = HashSequence(Sequence);
+            size_t Candidate = Table[Slot];
+            Table[Slot] = (uint32_t)(Pos + 1);
+            if(!Candidate || Pos + 1 - Candidate > LZ_MAX_OFFSET || Read32(In + Candidate - 1) != Sequence) {
+                // NOTE(Jovan): Step grows through incompressible data so it's skipped quickly
+                Pos += 1 + ((Pos - Anchor) >> 6);
+                continue;
+            }
+
+            size_t Match = Candidate - 1;
+            size_t Length = LZ_MIN_MATCH;
+            while(Pos + Length < MatchEnd && In[Match + Length] == In[Pos + Length]) {
+                ++Length;
+            }
+
+            Out = WriteSequence(Out, OutEnd, In + Anchor, Pos - Anchor, Pos - Match, Length);
+            if(!Out) {
+                return 0;
+            }
+            Pos += Length;
+            Anchor = Pos;
+        }
+    }
+
+    Out = WriteSequence(Out, OutEnd, In + Anchor, sourceSize - Anchor, 0, 0);
+    return Out ? (size_t)(Out - (unsigned char*)destination) : 0;
+}
+
+/**
+ * @brief Reads length extension bytes
+ *
+ * @return int 0 if input ended inside the length
+ */
+static int
+ReadLength(const unsigned char** in, const unsigned char* inEnd, size_t* length) {
+    unsigned char Byte;
+    do {
+        if(*in >= inEnd) {
+            return 0;
+        }
+        Byte = *(*in)++;
+        *length += Byte;
+    } while(Byte == 255);
+    return 1;
+}
+
+int
+LzDecompress(const void* source, size_t sourceSize, void* destination, size_t destinationSize) {
+    const unsigned char* In = (const unsigned char*)source;
+    const unsigned char* InEnd = In + sourceSize;
+    unsigned char* Out = (unsigned char*)destination;
+    unsigned char* OutBegin = Out;
+    unsigned char* OutEnd = Out + destinationSize;
+    while(In < InEnd) {
+        unsigned Token = *In++;
+        size_t NumLiterals = Token >> 4;
+        if(NumLiterals == 15 && !ReadLength(&In, InEnd, &NumLiterals)) {
+            return 0;
+        }
+        if(NumLiterals > (size_t)(InEnd - In) || NumLiterals > (size_t)(OutEnd - Out)) {
+            return 0;
+        }
+        memcpy(Out, In, NumLiterals);
+        In += NumLiterals;
+        Out += NumLiterals;
+        if(In == InEnd) {
+            break;
+        }
+
+        if(InEnd - In < 2) {
+            return 0;
+        }
+        size_t Offset = In[0] | ((size_t)In[1] << 8);
+        In += 2;
+        size_t Length = Token & 15;
+        if(Length == 15 && !ReadLength(&In, InEnd, &Length)) {
+            return 0;
+        }
+        Length += LZ_MIN_MATCH;
+        if(!Offset || Offset > (size_t)(Out - OutBegin) || Length > (size_t)(OutEnd - Out)) {
+            return 0;
+        }
+
+        const unsigned char* Match = Out - Offset;
+        if(Offset >= Length) {
+            memcpy(Out, Match, Length);
+            Out += Length;
+        } else {
+            // NOTE(Jovan): Overlapping match repeats the last Offset bytes, has to go front to back
+            for(size_t ByteIdx = 0; ByteIdx < Length; ++ByteIdx) {
+                *Out++ = Match[ByteIdx];
+            }
+        }
+    }
+    return Out == OutEnd;
+}
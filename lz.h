@@ -0,0 +1,50 @@
+/**
+ * @file lz.h
+ * @author Jovan Ivosevic
+ * @brief Fast byte-oriented LZ77 block codec for packed assets
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef LZ_H
+#define LZ_H
+
+#include <stddef.h>
+
+#define LZ_MIN_MATCH 4
+// NOTE(Jovan): Offsets are stored in 16 bits, blocks larger than the window still work but match less
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 12
+// NOTE(Jovan): Block always ends in literals and matches stop short of it, keeps the encoder free of tail checks
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_MARGIN 12
+
+/**
+ * @brief Compresses one independent block. Stream is a sequence of tokens, each with literal run
+ *        and match length nibbles extended by 255-runs, literals and a 16-bit little endian match offset.
+ *        The final sequence has literals only.
+ *
+ * @param source Input bytes
+ * @param sourceSize Input size
+ * @param destination Output buffer
+ * @param capacity Output buffer size
+ * @return size_t Compressed size, 0 if it doesn't fit into capacity
+ */
+size_t LzCompress(const void* source, size_t sourceSize, void* destination, size_t capacity);
+
+/**
+ * @brief Decompresses block produced by LzCompress. Every read and write is bounds checked,
+ *        so corrupt input fails instead of overrunning buffers.
+ *
+ * @param source Compressed bytes
+ * @param sourceSize Compressed size
+ * @param destination Output buffer
+ * @param destinationSize Exact decompressed size
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int LzDecompress(const void* source, size_t sourceSize, void* destination, size_t destinationSize);
+
+#endif
@@ -10,35 +10,52 @@
 #include <math.h>
 #include "cglm/cglm.h"
 #include "model.h"
+#include "jobs.h"
+#include "asyncload.h"
+#include "vfs.h"
+#include "shader.h"
+#include "filewatch.h"
+#include "resource.h"
+#include "instancing.h"
+#include "transform.h"
+#include "renderqueue.h"
+#include "glstate.h"
+
+#define VERTEX_SHADER_PATH "shaders/basic.vert"
+#define FRAGMENT_SHADER_PATH "shaders/basic.frag"
 
 /**
- * @brief Compiles GLSL shader
+ * @brief Rebuilds shader program whose source changed, data points to its ShaderResource
  *
- * @param type Type of shader: GL_VERTEX, GL_FRAGMENT
- * @param source Shader source code
  */
-static unsigned CompileShader(GLenum type, const char* source);
+static void OnShaderChanged(void* data, const char* filePath);
 
 /**
- * @brief Creates GLSL shader program
+ * @brief Starts reloading model whose source changed, data points to its ModelResource
  *
- * @param vertexShaderSource Vertex shader source code
- * @param fragmentShaderSource Fragment shader source code
  */
-static unsigned CreateShader(const char* vertexShaderSource, const char* fragmentShaderSource);
+static void OnModelChanged(void* data, const char* filePath);
 
 /**
- * @brief Sets mat4 uniform in GLSL shader
- *
- * @param programId GLSL Shader program ID
- * @param uniform Uniform name
- * @param m Pointer to matrix
+ * @brief Flags projection for recomputation, window user pointer points to the flag
  *
  */
-static void SetUniform4m(unsigned programId, const char* uniform, const mat4* m);
+static void OnWindowResize(GLFWwindow* window, int width, int height);
 
-int main(void)
+int main(int argc, char** argv)
 {
+    // ASSET PACK
+    // NOTE(Jovan): "--pack assets.pak <files>" bundles runtime assets and exits, "--pack-lz" also compresses them.
+    //             Loose files are used when there is no pack.
+    if (argc > 2 && (!strcmp(argv[1], "--pack") || !strcmp(argv[1], "--pack-lz")))
+    {
+        JobSystemInit(0);
+        int packed = WriteAssetPack(argv[2], (const char* const*)(argv + 3), (unsigned)(argc - 3), !strcmp(argv[1], "--pack-lz"));
+        JobSystemShutdown();
+        return packed ? 0 : 1;
+    }
+    VfsMount(VFS_DEFAULT_PACK);
+
     // GLFW INIT
     if (!glfwInit())
     {
@@ -64,6 +81,9 @@ int main(void)
         return 1;
     }
     glfwMakeContextCurrent(window);
+    int windowResized = 1;
+    glfwSetWindowUserPointer(window, &windowResized);
+    glfwSetWindowSizeCallback(window, OnWindowResize);
     
     // GLEW INIT
     if (glewInit() != GLEW_OK)
@@ -71,17 +91,38 @@ int main(void)
         printf("GLEW nije mogao da se ucita! :'(\n");
         return 1;
     }
+    if (!InitCameraBlock()) return 1;
 
     //------------------------------------------------------------------------------------
 
     // SETTINGS
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    StateEnable(GL_DEPTH_TEST);
+    StateEnable(GL_CULL_FACE);
     float intensity = 0.2f;
     glClearColor(0.3f * intensity, 0.5f * intensity, 1.0f * intensity, 1.0f);
 
+    // WORKER THREADS
+    // NOTE(Jovan): Assets are requested first, so reads and imports run on workers while the VAOs below are built.
+    //             GL work of finished jobs comes back to this thread.
+    if (!JobSystemInit(0)) printf("Worker threads unavailable, loading on main thread\n");
+    InitAsyncLoader(window);
+
     // SHADER PROGRAM
-    unsigned int unifiedShader = CreateShader("shaders/basic.vert", "shaders/basic.frag");
+    ShaderResource* basicShader = AcquireShader(VERTEX_SHADER_PATH, FRAGMENT_SHADER_PATH);
+    if (!basicShader) return 1;
+    WatchFile(VERTEX_SHADER_PATH, OnShaderChanged, basicShader);
+    WatchFile(FRAGMENT_SHADER_PATH, OnShaderChanged, basicShader);
+
+    // .obj MODEL
+    ModelResource* camileResource = AcquireModel("kamila.obj");
+    if (!camileResource)
+    {
+        printf("Failed to open \"*.obj\"");
+        return 1;
+    }
+    Model* camile = GetModel(camileResource);
+    int camileReported = 0;
+    WatchFile("kamila.obj", OnModelChanged, camileResource);
 
 
     // VERTEX DATA
@@ -215,6 +256,31 @@ int main(void)
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     }
+    // NOTE(Jovan): Pyramids share one mesh, all of them go out in a single instanced draw
+    InstanceBatch pyramids;
+    if (!CreateInstanceBatch(&pyramids, pyramid_vao, GL_TRIANGLES, 0, 12))
+    {
+        return 1;
+    }
+    {
+        float pyramidPlacements[][4] = {
+            // x, y, z, scale
+            {  0.0f, 0.0f, 10.0f, 2.0f },
+            { -2.8f, 0.0f,  8.2f, 1.2f },
+            {  3.0f, 0.0f,  8.4f, 1.4f },
+            { -4.0f, 0.0f,  6.0f, 1.0f },
+            {  4.3f, 0.0f,  4.5f, 0.9f },
+        };
+        for (unsigned i = 0; i < sizeof(pyramidPlacements) / sizeof(pyramidPlacements[0]); ++i)
+        {
+            mat4 pyramidModel;
+            vec3 pyramidScale = { pyramidPlacements[i][3], pyramidPlacements[i][3], pyramidPlacements[i][3] };
+            glm_mat4_identity(pyramidModel);
+            glm_translate(pyramidModel, pyramidPlacements[i]);
+            glm_scale(pyramidModel, pyramidScale);
+            PushInstance(&pyramids, pyramidModel, NULL);
+        }
+    }
     unsigned int carpet_vao, carpet_vbo;
     {
         glGenVertexArrays(1, &carpet_vao);
@@ -245,12 +311,16 @@ int main(void)
     }
 
 
-    // .obj MODEL
-    Model camile;
-    if (!LoadModel("kamila.obj", &camile)) printf("Failed to open \"*.obj\"");
+    // NOTE(Jovan): VAOs above were built with plain GL binds, the state cache starts over from here
+    StateInvalidate();
+
+    // First frame needs the program, the model streams in while rendering
+    while (GetShaderResourceState(basicShader) == RESOURCE_PENDING) JobRunMain(1);
+    unsigned int unifiedShader = GetShaderProgram(basicShader);
 
     // TRANSFORMATIONS
     mat4 model, view, projection;
+    RenderView renderView;
     glm_mat4_identity(&model);
     glm_mat4_identity(&view);
     glm_mat4_identity(&projection);
@@ -269,7 +339,65 @@ int main(void)
 
     //glm_translate(&model, translate_vector);
     glm_look(pos, dir, up, &view);
+    glm_vec3_copy(pos, renderView.CameraPosition);
     float t = 0.90f, speed = 0.001f, time = 0.0f;
+    RenderQueue renderQueue = { 0 };
+
+    // SCENE TRANSFORMS
+    // NOTE(Jovan): Static objects are placed once and keep their cached world matrices,
+    //             only transforms touched in the loop are recomputed
+    versor rotation, moonRotation;
+    TransformId planeTransform = CreateTransform(TRANSFORM_NONE);
+    {
+        // Plane was moved to -100 after being turned around, which lands it at +100
+        translate_vector[0] = 0.0f;
+        translate_vector[1] = 0.0f;
+        translate_vector[2] = 100.0f;
+        SetTransformPosition(planeTransform, translate_vector);
+        glm_quatv(rotation, glm_rad(180.0f), up);
+        SetTransformRotation(planeTransform, rotation);
+    }
+    // Both moon halves share position and non-uniform scale, which is applied after their rotations
+    TransformId moonTransform = CreateTransform(TRANSFORM_NONE);
+    TransformId moonFrontTransform = CreateTransform(moonTransform);
+    TransformId moonBackTransform = CreateTransform(moonTransform);
+    {
+        translate_vector[0] = 2.0f;
+        translate_vector[1] = 8.0f;
+        translate_vector[2] = 50.0f;
+        SetTransformPosition(moonTransform, translate_vector);
+        scale_vector[0] = 2.0f * 1.5;
+        scale_vector[1] = 1.42f * 1.5;
+        scale_vector[2] = 2.0f * 1.5;
+        SetTransformScale(moonTransform, scale_vector);
+        vec3 axis = { 1.0f, 0.0f, 0.0f };
+        glm_quatv(moonRotation, glm_rad(30.0f), axis);
+        SetTransformRotation(moonFrontTransform, moonRotation);
+        axis[2] = 1.0f;
+        glm_quatv(rotation, glm_rad(180.0f), axis);
+        glm_quat_mul(moonRotation, rotation, moonRotation);
+        SetTransformRotation(moonBackTransform, moonRotation);
+    }
+    TransformId carpetTransform = CreateTransform(TRANSFORM_NONE);
+    {
+        glm_quatv(rotation, glm_rad(80.0f), up);
+        SetTransformRotation(carpetTransform, rotation);
+        scale_vector[0] = 0.06f;
+        scale_vector[1] = 0.01f;
+        scale_vector[2] = 0.04f;
+        SetTransformScale(carpetTransform, scale_vector);
+    }
+    TransformId camileTransform = CreateTransform(TRANSFORM_NONE);
+    {
+        scale_vector[0] = 0.001f;
+        scale_vector[1] = 0.001f;
+        scale_vector[2] = 0.001f;
+        SetTransformScale(camileTransform, scale_vector);
+    }
+    if (planeTransform == TRANSFORM_NONE || moonBackTransform == TRANSFORM_NONE || camileTransform == TRANSFORM_NONE)
+    {
+        return 1;
+    }
 
     // MAIN LOOP
     while (!glfwWindowShouldClose(window))
@@ -278,236 +406,104 @@ int main(void)
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         glfwPollEvents();
 
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) t -= speed;
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) t += speed;
-        if (t < 0.0f) t = 0.0f;
-        else if (t > 1.0f) t = 1.0f;
-
-        // GET WINDOW SIZE, UPDATE ASPECT RATIO
-        glfwGetWindowSize(window, &wWidth, &wHeight);
-        glViewport(0, 0, wWidth, wHeight);
-        glm_perspective(glm_rad(47.0f), (float)wWidth / (float)wHeight, 0.1f, 100.0f, &projection);
-
-        // USE SHADER PROGRAM, PASS TRANSFORMATION MATRICES AS UNIFORMS
-        glUseProgram(unifiedShader);
-        SetUniform4m(unifiedShader, "uView", view);
-        SetUniform4m(unifiedShader, "uProjection", projection);
-
-
-        //// RENDER
-        // PLANE
-        glBindVertexArray(plane_vao);
-        {
-            glm_mat4_identity(&model);
-            glm_rotate(model, glm_rad(180.0f), up);
-            translate_vector[0] = 0.0f;
-            translate_vector[1] = 0.0f;
-            translate_vector[2] = -100.0f;
-            glm_translate(&model, translate_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        // HOT RELOAD
+        PollFileWatches();
 
-        }
-        // PYRAMIDS
-        glBindVertexArray(pyramid_vao);
-        // PYRAMID 1
+        // STREAM IN MODELS
+        ProcessResources();
+        if (!camileReported && GetModelResourceState(camileResource) != MODEL_LOAD_PENDING)
         {
-            glm_mat4_identity(&model);
-            translate_vector[0] = 0.0f;
-            translate_vector[1] = 0.0f;
-            translate_vector[2] = 10.0f;
-            glm_translate(&model, translate_vector);
-            scale_vector[0] = 2.0f;
-            scale_vector[1] = 2.0f;
-            scale_vector[2] = 2.0f;
-            glm_scale(&model, scale_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
+            if (GetModelResourceState(camileResource) == MODEL_LOAD_FAILED) printf("Failed to open \"*.obj\"");
+            else WriteLoadProfileJson(&camile->Profile, "kamila.obj", stdout);
+            camileReported = 1;
         }
-        // PYRAMID 2
-        {
-            glm_mat4_identity(&model);
-            translate_vector[0] = -2.8f;
-            translate_vector[1] = 0.0f;
-            translate_vector[2] = 8.2f;
-            glm_translate(&model, translate_vector);
-            scale_vector[0] = 1.2f;
-            scale_vector[1] = 1.2f;
-            scale_vector[2] = 1.2f;
-            glm_scale(&model, scale_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-        }
-        // PYRAMID 3
-        {
-            glm_mat4_identity(&model);
-            translate_vector[0] = 3.0f;
-            translate_vector[1] = 0.0f;
-            translate_vector[2] = 8.4f;
-            glm_translate(&model, translate_vector);
-            scale_vector[0] = 1.4f;
-            scale_vector[1] = 1.4f;
-            scale_vector[2] = 1.4f;
-            glm_scale(&model, scale_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-        }
-        // PYRAMID 4
+
+        // NOTE(Jovan): Files the model references are only known once it is loaded, reloads may add new ones
+        for (unsigned sourceIdx = 0; sourceIdx < camile->Sources.NumSources; ++sourceIdx)
         {
-            glm_mat4_identity(&model);
-            translate_vector[0] = -4.0f;
-            translate_vector[1] = 0.0f;
-            translate_vector[2] = 6.0f;
-            glm_translate(&model, translate_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
+            WatchFile(camile->Sources.Sources[sourceIdx].Path, OnModelChanged, camileResource);
         }
-        // PYRAMID 5
-        {
-            glm_mat4_identity(&model);
-            translate_vector[0] = 4.3f;
-            translate_vector[1] = 0.0f;
-            translate_vector[2] = 4.5f;
-            glm_translate(&model, translate_vector);
-            scale_vector[0] = 0.9f;
-            scale_vector[1] = 0.9f;
-            scale_vector[2] = 0.9f;
-            glm_scale(&model, scale_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
 
-        }
+        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) t -= speed;
+        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) t += speed;
+        if (t < 0.0f) t = 0.0f;
+        else if (t > 1.0f) t = 1.0f;
 
-        //MOON
+        // UPDATE ASPECT RATIO AFTER RESIZE
+        if (windowResized)
         {
-            glBindVertexArray(moon_vao);
-            glm_mat4_identity(&model);
-            translate_vector[0] = 2.0f;
-            translate_vector[1] = 8.0f;
-            translate_vector[2] = 50.0f;
-            glm_translate(&model, translate_vector);
-            scale_vector[0] = 2.0f *1.5;
-            scale_vector[1] = 1.42f * 1.5;
-            scale_vector[2] = 2.0f * 1.5;
-            glm_scale(&model, scale_vector);
-            vec3 axis = { 1.0f, 0.0f, 0.0f };
-            glm_rotate(model, glm_rad(30.0f), axis);
-
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-            axis[0] = 1.0f;
-            axis[1] = 0.0f;
-            axis[2] = 1.0f;
-            glm_rotate(model, glm_rad(180.0f), axis);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 12);
-
-
-
-
+            glfwGetWindowSize(window, &wWidth, &wHeight);
+            glViewport(0, 0, wWidth, wHeight);
+            // NOTE(Jovan): Minimized windows report zero size, previous projection stays until they're restored
+            if (wWidth > 0 && wHeight > 0)
+            {
+                glm_perspective(glm_rad(47.0f), (float)wWidth / (float)wHeight, 0.1f, 100.0f, projection);
+                // NOTE(Jovan): Camera doesn't move, so the shared block only changes with the projection
+                UpdateCameraBlock(view, projection);
+                glm_mat4_mul(projection, view, renderView.ViewProjection);
+                renderView.PixelScale = projection[1][1] * (float)wHeight * 0.5f;
+            }
+            windowResized = 0;
         }
 
-
+        // MOVE CAMEL AND CARPET
+        translate_vector[0] = camile_start_pos[0] + t * (camile_end_pos[0] - camile_start_pos[0]) - 0.0f;
+        translate_vector[1] = camile_start_pos[1] + t * (camile_end_pos[1] - camile_start_pos[1]) - 0.0f + sin(time) * 0.002f;
+        translate_vector[2] = camile_start_pos[2] + t * (camile_end_pos[2] - camile_start_pos[2]) - 0.0f;
+        SetTransformPosition(camileTransform, translate_vector);
+        translate_vector[1] -= 0.013f;
+        translate_vector[2] -= 0.04f;
+        SetTransformPosition(carpetTransform, translate_vector);
+        UpdateTransforms();
+
+        // QUEUE AND RENDER
+        // NOTE(Jovan): Draw order comes from the sort keys: program, VAO, then front to back
+        unifiedShader = GetShaderProgram(basicShader);
+        BeginRenderQueue(&renderQueue, &renderView, 100.0f);
+        // PLANE
+        SubmitArrays(&renderQueue, RENDER_PASS_OPAQUE, unifiedShader, plane_vao, GL_TRIANGLES, 0, 6, GetWorldMatrix(planeTransform));
+        // PYRAMIDS
+        SubmitInstances(&renderQueue, RENDER_PASS_OPAQUE, unifiedShader, &pyramids);
+        // MOON
+        SubmitArrays(&renderQueue, RENDER_PASS_OPAQUE, unifiedShader, moon_vao, GL_TRIANGLES, 0, 12, GetWorldMatrix(moonFrontTransform));
+        SubmitArrays(&renderQueue, RENDER_PASS_OPAQUE, unifiedShader, moon_vao, GL_TRIANGLES, 0, 12, GetWorldMatrix(moonBackTransform));
         // CARPET
-        {
-            glm_mat4_identity(&model);
-            translate_vector[0] = camile_start_pos[0] + t * (camile_end_pos[0] - camile_start_pos[0]) - 0.0f;
-            translate_vector[1] = camile_start_pos[1] + t * (camile_end_pos[1] - camile_start_pos[1]) - 0.013f + sin(time) * 0.002f;
-            translate_vector[2] = camile_start_pos[2] + t * (camile_end_pos[2] - camile_start_pos[2]) - 0.04f;
-            glm_translate(&model, translate_vector);
-            glm_rotate(model, glm_rad(80.0f), up);
-            scale_vector[0] = 0.06f;
-            scale_vector[1] = 0.01f;
-            scale_vector[2] = 0.04f;
-            glm_scale(&model, scale_vector);
-            glBindVertexArray(carpet_vao);
-            SetUniform4m(unifiedShader, "uModel", model);
-            glDrawArrays(GL_TRIANGLES, 0, 24);
-        }
+        SubmitArrays(&renderQueue, RENDER_PASS_OPAQUE, unifiedShader, carpet_vao, GL_TRIANGLES, 0, 24, GetWorldMatrix(carpetTransform));
         // CAMEL - MODEL(.obj)
-        {
-            glm_mat4_identity(&model);
-            translate_vector[0] = camile_start_pos[0] + t * (camile_end_pos[0] - camile_start_pos[0]) - 0.0f;
-            translate_vector[1] = camile_start_pos[1] + t * (camile_end_pos[1] - camile_start_pos[1]) - 0.0f + sin(time) * 0.002f;
-            translate_vector[2] = camile_start_pos[2] + t * (camile_end_pos[2] - camile_start_pos[2]) - 0.0f;
-            glm_translate(&model, translate_vector);
-            scale_vector[0] = 0.001f;
-            scale_vector[1] = 0.001f;
-            scale_vector[2] = 0.001f;
-            glm_scale(&model, scale_vector);
-            SetUniform4m(unifiedShader, "uModel", model);
-            RenderModel(&camile);
-        }
+        SubmitModel(&renderQueue, RENDER_PASS_OPAQUE, unifiedShader, camile, GetWorldMatrix(camileTransform));
+        ExecuteRenderQueue(&renderQueue);
 
         glfwSwapBuffers(window);
     }
+    ClearFileWatches();
+    ReleaseModel(camileResource);
+    ReleaseShader(basicShader);
+    FreeInstanceBatch(&pyramids);
+    ClearTransforms();
+    FreeRenderQueue(&renderQueue);
+    GlStateStats stateStats = StateGetStats();
+    printf("GL state calls: %llu issued, %llu elided\n", (unsigned long long)stateStats.Issued, (unsigned long long)stateStats.Elided);
+    FreeCameraBlock();
+    ShutdownAsyncLoader();
+    JobSystemShutdown();
+    ShutdownResources();
+    VfsUnmount();
     glfwTerminate();
     return 0;
 }
 
-unsigned CompileShader(GLenum type, const char* source) {
-    unsigned int id, result, logLength;
-    char* sourceCode = NULL, * errorMessage = NULL;
-    long shaderSize;
-    FILE* inputFile = 0;
-
-    id = glCreateShader(type);
-    inputFile = fopen(source, "r");
-    if (!inputFile)
-    {
-        fprintf(stderr, "ERROR: %s file not found.\n", source);
-        return 0;
-    }
-
-    fseek(inputFile, 0L, SEEK_END);
-    shaderSize = ftell(inputFile);
-    fseek(inputFile, 0L, SEEK_SET);
-    sourceCode = (char*)calloc(shaderSize, sizeof(char));
-
-    if (!sourceCode) {
-        fprintf(stderr, "ERROR: Could not load source code.\n");
-        return 0;
-    }
-
-    fread(sourceCode, sizeof(char), shaderSize, inputFile);
-    fclose(inputFile);
-
-    glShaderSource(id, 1, &sourceCode, NULL);
-    glCompileShader(id);
-
-    free(sourceCode);
-
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE)
-    {
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &logLength);
-        errorMessage = (char*)calloc(logLength, sizeof(char));
-        glGetShaderInfoLog(id, logLength, &logLength, errorMessage);
-        fprintf(stderr, "ERROR compiling shader: %s\n", errorMessage);
-        free(errorMessage);
-    }
-
-    return id;
+static void OnShaderChanged(void* data, const char* filePath) {
+    (void)filePath;
+    ReloadShaderResource((ShaderResource*)data);
 }
 
-unsigned CreateShader(const char* vertexShaderSource, const char* fragmentShaderSource) {
-    unsigned int program, vertexShader, fragmentShader;
-
-    program = glCreateProgram();
-    vertexShader = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-    glLinkProgram(program);
-    glValidateProgram(program);
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    return program;
+static void OnModelChanged(void* data, const char* filePath) {
+    (void)filePath;
+    ReloadModelResource((ModelResource*)data);
 }
 
-static void SetUniform4m(unsigned programId, const char* uniform, const mat4* m) {
-    glUniformMatrix4fv(glGetUniformLocation(programId, uniform), 1, GL_FALSE, (float*)m);
+static void OnWindowResize(GLFWwindow* window, int width, int height) {
+    (void)width;
+    (void)height;
+    *(int*)glfwGetWindowUserPointer(window) = 1;
 }
\ No newline at end of file
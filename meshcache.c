@@ -0,0 +1,450 @@
+#include "meshcache.h"
+#include "hash.h"
+#include "vfs.h"
+
+#include <string.h>
+
+static uint64_t
+AlignUp(uint64_t value) {
+    return (value + MESH_CACHE_ALIGNMENT - 1) & ~(uint64_t)(MESH_CACHE_ALIGNMENT - 1);
+}
+
+static int
+CachePath(const char* sourcePath, char* path) {
+    size_t Length = strlen(sourcePath);
+    if(Length + sizeof(MESH_CACHE_EXTENSION) + 4 > MESH_CACHE_MAX_PATH) {
+        return 0;
+    }
+
+    memcpy(path, sourcePath, Length);
+    memcpy(path + Length, MESH_CACHE_EXTENSION, sizeof(MESH_CACHE_EXTENSION));
+    return 1;
+}
+
+static int
+HashSource(const char* sourcePath, uint64_t* hash) {
+    VfsFile Source;
+    if(!VfsOpenFile(sourcePath, &Source)) {
+        return 0;
+    }
+
+    *hash = HashBytes(Source.Data, Source.Size, 0);
+    VfsCloseFile(&Source);
+    return 1;
+}
+
+static uint64_t
+AlignIndexOffset(uint64_t offset) {
+    return (offset + sizeof(uint32_t) - 1) & ~(uint64_t)(sizeof(uint32_t) - 1);
+}
+
+static uint32_t
+MeshIndexSize(const MeshData* mesh) {
+    return mesh->NumVertices <= MAX_INDEX16_VERTICES ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+static uint16_t
+FloatToHalf(float value) {
+    uint32_t Bits;
+    memcpy(&Bits, &value, sizeof(Bits));
+    uint32_t Sign = (Bits >> 16) & 0x8000;
+    uint32_t Mantissa = Bits & 0x7FFFFF;
+    int32_t Exponent = (int32_t)((Bits >> 23) & 0xFF) - 127 + 15;
+    if(((Bits >> 23) & 0xFF) == 0xFF) {
+        return (uint16_t)(Sign | 0x7C00 | (Mantissa ? 0x200 : 0));
+    }
+    if(Exponent >= 31) {
+        return (uint16_t)(Sign | 0x7C00);
+    }
+
+    // NOTE(Jovan): Round to nearest even, carry out of mantissa correctly bumps exponent
+    uint32_t Shift = 13;
+    uint32_t Half;
+    if(Exponent <= 0) {
+        if(Exponent < -10) {
+            return (uint16_t)Sign;
+        }
+        Mantissa |= 0x800000;
+        Shift = 14 - Exponent;
+        Half = Mantissa >> Shift;
+    } else {
+        Half = ((uint32_t)Exponent << 10) | (Mantissa >> Shift);
+    }
+
+    uint32_t Remainder = Mantissa & ((1u << Shift) - 1);
+    uint32_t Halfway = 1u << (Shift - 1);
+    if(Remainder > Halfway || (Remainder == Halfway && (Half & 1))) {
+        ++Half;
+    }
+    return (uint16_t)(Sign | Half);
+}
+
+static uint16_t
+FloatToSnorm16(float value) {
+    value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    float Scaled = value * 32767.0f;
+    return (uint16_t)(int16_t)(Scaled < 0.0f ? Scaled - 0.5f : Scaled + 0.5f);
+}
+
+/**
+ * @brief Packs signed normalized xyz into 10 bits each and w into the top 2 bits, as read by GL_INT_2_10_10_10_REV
+ *
+ */
+static uint32_t
+PackSnorm1010102(const float* xyz, float w) {
+    uint32_t Result = 0;
+    for(unsigned Axis = 0; Axis < 3; ++Axis) {
+        float Value = xyz[Axis] < -1.0f ? -1.0f : (xyz[Axis] > 1.0f ? 1.0f : xyz[Axis]);
+        float Scaled = Value * 511.0f;
+        int32_t Quantized = (int32_t)(Scaled < 0.0f ? Scaled - 0.5f : Scaled + 0.5f);
+        Result |= ((uint32_t)Quantized & 0x3FFu) << (10 * Axis);
+    }
+    int32_t Handedness = w < 0.0f ? -1 : 1;
+    return Result | ((uint32_t)Handedness & 0x3u) << 30;
+}
+
+static void
+ComputeDequantization(MeshCacheHeader* header, const MeshRange* ranges) {
+    for(unsigned Axis = 0; Axis < 3; ++Axis) {
+        header->PosScale[Axis] = 1.0f;
+        header->PosOffset[Axis] = 0.0f;
+    }
+    if(header->VertexFormat == VERTEX_FORMAT_FLOAT) {
+        return;
+    }
+
+    float BoundsMin[3], BoundsMax[3];
+    int Empty = 1;
+    for(unsigned MeshIdx = 0; MeshIdx < header->NumMeshes; ++MeshIdx) {
+        if(!ranges[MeshIdx].NumVertices) {
+            continue;
+        }
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            if(Empty || ranges[MeshIdx].BoundsMin[Axis] < BoundsMin[Axis]) BoundsMin[Axis] = ranges[MeshIdx].BoundsMin[Axis];
+            if(Empty || ranges[MeshIdx].BoundsMax[Axis] > BoundsMax[Axis]) BoundsMax[Axis] = ranges[MeshIdx].BoundsMax[Axis];
+        }
+        Empty = 0;
+    }
+    if(Empty) {
+        return;
+    }
+
+    // NOTE(Jovan): Positions are mapped to [-1, 1] over model bounds, which also keeps half floats in their most precise range
+    for(unsigned Axis = 0; Axis < 3; ++Axis) {
+        float Extent = 0.5f * (BoundsMax[Axis] - BoundsMin[Axis]);
+        header->PosOffset[Axis] = 0.5f * (BoundsMax[Axis] + BoundsMin[Axis]);
+        header->PosScale[Axis] = Extent > 0.0f ? Extent : 1.0f;
+    }
+}
+
+static void
+PackMeshVertices(const MeshData* mesh, const MeshCacheHeader* header, unsigned char* vertices) {
+    if(header->VertexFormat == VERTEX_FORMAT_FLOAT) {
+        if(mesh->NumVertices) {
+            memcpy(vertices, mesh->Vertices, mesh->NumVertices * sizeof(Vertex));
+        }
+        return;
+    }
+
+    PackedVertex* Packed = (PackedVertex*)vertices;
+    for(unsigned VertIdx = 0; VertIdx < mesh->NumVertices; ++VertIdx) {
+        const Vertex* Source = &mesh->Vertices[VertIdx];
+        PackedVertex* Destination = &Packed[VertIdx];
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            float Normalized = (Source->Position[Axis] - header->PosOffset[Axis]) / header->PosScale[Axis];
+            Destination->Position[Axis] = header->VertexFormat == VERTEX_FORMAT_HALF
+                ? FloatToHalf(Normalized)
+                : FloatToSnorm16(Normalized);
+        }
+        Destination->Padding = 0;
+        Destination->Normal = PackSnorm1010102(Source->Normal, 1.0f);
+        Destination->Tangent = PackSnorm1010102(Source->Tangent, Source->Tangent[3]);
+    }
+}
+
+static void
+PackIndices(const unsigned* indices, unsigned numIndices, unsigned indexSize, unsigned char* dst) {
+    if(indexSize == sizeof(uint16_t)) {
+        uint16_t* ShortIndices = (uint16_t*)dst;
+        for(unsigned Idx = 0; Idx < numIndices; ++Idx) {
+            ShortIndices[Idx] = (uint16_t)indices[Idx];
+        }
+    } else if(numIndices) {
+        memcpy(dst, indices, numIndices * sizeof(unsigned));
+    }
+}
+
+static void
+AssignPointers(BakedModel* baked, const unsigned char* image) {
+    baked->Header = (const MeshCacheHeader*)image;
+    baked->Meshes = (const MeshRange*)(image + baked->Header->MeshTableOffset);
+    baked->Meshlets = (const Meshlet*)(image + baked->Header->MeshletOffset);
+    baked->Materials = (const Material*)(image + baked->Header->MaterialOffset);
+    baked->Vertices = image + baked->Header->VertexOffset;
+    baked->Indices = image + baked->Header->IndexOffset;
+}
+
+int
+BakeModelData(const ModelData* data, BakedModel* baked, LoadProfile* profile) {
+    memset(baked, 0, sizeof(BakedModel));
+    uint64_t NumVertices = 0, IndexBytes = 0, NumMeshlets = 0;
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        NumVertices += CurrMesh->NumVertices;
+        NumMeshlets += CurrMesh->NumMeshlets;
+        IndexBytes = AlignIndexOffset(IndexBytes) + ((uint64_t)CurrMesh->NumIndices + CurrMesh->NumLodIndices) * MeshIndexSize(CurrMesh);
+    }
+
+    if(IndexBytes > UINT32_MAX) {
+        fprintf(stderr, "Model indices do not fit mesh cache.\n");
+        return LOAD_FAIL;
+    }
+
+    MeshCacheHeader Header = { 0 };
+    Header.Magic = MESH_CACHE_MAGIC;
+    Header.Version = MESH_CACHE_VERSION;
+    Header.VertexStride = VertexFormatStride(VERTEX_FORMAT);
+    Header.VertexFormat = VERTEX_FORMAT;
+    Header.NumMeshes = data->NumMeshes;
+    Header.NumMaterials = data->NumMaterials;
+    Header.MeshTableOffset = AlignUp(sizeof(MeshCacheHeader));
+    Header.MaterialOffset = AlignUp(Header.MeshTableOffset + data->NumMeshes * sizeof(MeshRange));
+    Header.MeshletOffset = AlignUp(Header.MaterialOffset + data->NumMaterials * sizeof(Material));
+    Header.NumMeshlets = NumMeshlets;
+    Header.VertexOffset = AlignUp(Header.MeshletOffset + NumMeshlets * sizeof(Meshlet));
+    Header.VertexBytes = NumVertices * Header.VertexStride;
+    Header.IndexOffset = AlignUp(Header.VertexOffset + Header.VertexBytes);
+    Header.IndexBytes = IndexBytes;
+    Header.FileSize = Header.IndexOffset + Header.IndexBytes;
+
+    unsigned char* Image = (unsigned char*)calloc(1, (size_t)Header.FileSize);
+    if(!Image) {
+        fprintf(stderr, "Failed to allocate baked model.\n");
+        return LOAD_FAIL;
+    }
+
+    MeshCacheHeader* ImageHeader = (MeshCacheHeader*)Image;
+    memcpy(ImageHeader, &Header, sizeof(Header));
+    MeshRange* Ranges = (MeshRange*)(Image + Header.MeshTableOffset);
+    if(data->NumMaterials) {
+        memcpy(Image + Header.MaterialOffset, data->Materials, data->NumMaterials * sizeof(Material));
+    }
+    Meshlet* Meshlets = (Meshlet*)(Image + Header.MeshletOffset);
+    unsigned char* Vertices = Image + Header.VertexOffset;
+    unsigned char* Indices = Image + Header.IndexOffset;
+    uint32_t FirstVertex = 0, FirstMeshlet = 0;
+    uint64_t IndexOffset = 0;
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        MeshRange* CurrRange = &Ranges[MeshIdx];
+        CurrRange->FirstVertex = FirstVertex;
+        CurrRange->NumVertices = CurrMesh->NumVertices;
+        IndexOffset = AlignIndexOffset(IndexOffset);
+        CurrRange->IndexOffset = (uint32_t)IndexOffset;
+        CurrRange->NumIndices = CurrMesh->NumIndices + CurrMesh->NumLodIndices;
+        CurrRange->IndexSize = MeshIndexSize(CurrMesh);
+        CurrRange->Material = CurrMesh->Material;
+        CurrRange->NumLods = CurrMesh->NumLods;
+        memcpy(CurrRange->Lods, CurrMesh->Lods, sizeof(CurrRange->Lods));
+        CurrRange->FirstMeshlet = FirstMeshlet;
+        CurrRange->NumMeshlets = CurrMesh->NumMeshlets;
+        if(CurrMesh->NumMeshlets) {
+            memcpy(&Meshlets[FirstMeshlet], CurrMesh->Meshlets, CurrMesh->NumMeshlets * sizeof(Meshlet));
+        }
+        FirstMeshlet += CurrMesh->NumMeshlets;
+        CurrRange->Acmr = CurrMesh->Acmr;
+        CurrRange->Atvr = CurrMesh->Atvr;
+
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            CurrRange->BoundsMin[Axis] = CurrMesh->NumVertices ? CurrMesh->Vertices[0].Position[Axis] : 0.0f;
+            CurrRange->BoundsMax[Axis] = CurrRange->BoundsMin[Axis];
+        }
+        for(unsigned VertIdx = 0; VertIdx < CurrMesh->NumVertices; ++VertIdx) {
+            const float* Position = CurrMesh->Vertices[VertIdx].Position;
+            for(unsigned Axis = 0; Axis < 3; ++Axis) {
+                if(Position[Axis] < CurrRange->BoundsMin[Axis]) CurrRange->BoundsMin[Axis] = Position[Axis];
+                if(Position[Axis] > CurrRange->BoundsMax[Axis]) CurrRange->BoundsMax[Axis] = Position[Axis];
+            }
+        }
+
+        FirstVertex += CurrMesh->NumVertices;
+        IndexOffset += (uint64_t)CurrRange->NumIndices * CurrRange->IndexSize;
+    }
+
+    ComputeDequantization(ImageHeader, Ranges);
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        const MeshRange* CurrRange = &Ranges[MeshIdx];
+        uint64_t Start = ProfileStart();
+        PackMeshVertices(CurrMesh, ImageHeader, Vertices + (size_t)CurrRange->FirstVertex * Header.VertexStride);
+        double Seconds = ProfileElapsed(Start);
+        uint64_t Bytes = (uint64_t)CurrRange->NumVertices * Header.VertexStride;
+        ProfileAddMeshStage(profile, MeshIdx, PROFILE_STAGE_VERTEX_CONVERSION, Seconds, Bytes);
+        ProfileAddStage(profile, PROFILE_STAGE_VERTEX_CONVERSION, Seconds, Bytes);
+
+        // NOTE(Jovan): Simplified levels follow the full detail indices, level ranges are relative to the mesh
+        Start = ProfileStart();
+        unsigned char* MeshIndices = Indices + CurrRange->IndexOffset;
+        PackIndices(CurrMesh->Indices, CurrMesh->NumIndices, CurrRange->IndexSize, MeshIndices);
+        PackIndices(CurrMesh->LodIndices, CurrMesh->NumLodIndices, CurrRange->IndexSize,
+                    MeshIndices + (size_t)CurrMesh->NumIndices * CurrRange->IndexSize);
+        Seconds = ProfileElapsed(Start);
+        Bytes = (uint64_t)CurrRange->NumIndices * CurrRange->IndexSize;
+        ProfileAddMeshStage(profile, MeshIdx, PROFILE_STAGE_INDEX_BUILD, Seconds, Bytes);
+        ProfileAddStage(profile, PROFILE_STAGE_INDEX_BUILD, Seconds, Bytes);
+    }
+
+    baked->Memory = Image;
+    AssignPointers(baked, Image);
+    return LOAD_SUCCESS;
+}
+
+static int
+ValidateImage(const unsigned char* image, size_t size) {
+    if(size < sizeof(MeshCacheHeader)) {
+        return 0;
+    }
+
+    const MeshCacheHeader* Header = (const MeshCacheHeader*)image;
+    if(Header->Magic != MESH_CACHE_MAGIC || Header->Version != MESH_CACHE_VERSION
+       || Header->VertexFormat != VERTEX_FORMAT || Header->VertexStride != VertexFormatStride(VERTEX_FORMAT)
+       || Header->FileSize != size) {
+        return 0;
+    }
+
+    if(Header->Sources.NumSources > MAX_MODEL_SOURCES) {
+        return 0;
+    }
+    for(unsigned SourceIdx = 0; SourceIdx < Header->Sources.NumSources; ++SourceIdx) {
+        if(!memchr(Header->Sources.Sources[SourceIdx].Path, '\0', MODEL_SOURCE_MAX_PATH)) {
+            return 0;
+        }
+    }
+
+    // NOTE(Jovan): Sizes are compared against the room left after each offset, so huge offsets can't wrap around
+    if(Header->NumMaterials > MAX_MATERIALS || Header->NumMeshlets > size / sizeof(Meshlet)
+       || Header->MeshTableOffset > size || (uint64_t)Header->NumMeshes * sizeof(MeshRange) > size - Header->MeshTableOffset
+       || Header->MaterialOffset > size || (uint64_t)Header->NumMaterials * sizeof(Material) > size - Header->MaterialOffset
+       || Header->MeshletOffset > size || Header->NumMeshlets * sizeof(Meshlet) > size - Header->MeshletOffset
+       || Header->VertexOffset > size || Header->VertexBytes > size - Header->VertexOffset
+       || Header->IndexOffset > size || Header->IndexBytes > size - Header->IndexOffset
+       || Header->MeshTableOffset % MESH_CACHE_ALIGNMENT || Header->MaterialOffset % MESH_CACHE_ALIGNMENT
+       || Header->MeshletOffset % MESH_CACHE_ALIGNMENT || Header->VertexOffset % MESH_CACHE_ALIGNMENT
+       || Header->IndexOffset % MESH_CACHE_ALIGNMENT) {
+        return 0;
+    }
+
+    const MeshRange* Ranges = (const MeshRange*)(image + Header->MeshTableOffset);
+    for(unsigned MeshIdx = 0; MeshIdx < Header->NumMeshes; ++MeshIdx) {
+        const MeshRange* CurrRange = &Ranges[MeshIdx];
+        if(((uint64_t)CurrRange->FirstVertex + CurrRange->NumVertices) * Header->VertexStride > Header->VertexBytes
+           || (CurrRange->IndexSize != sizeof(uint16_t) && CurrRange->IndexSize != sizeof(uint32_t))
+           || CurrRange->IndexOffset % CurrRange->IndexSize
+           || CurrRange->IndexOffset + (uint64_t)CurrRange->NumIndices * CurrRange->IndexSize > Header->IndexBytes
+           || (uint64_t)CurrRange->FirstMeshlet + CurrRange->NumMeshlets > Header->NumMeshlets
+           || CurrRange->Material >= Header->NumMaterials) {
+            return 0;
+        }
+
+        if(CurrRange->NumLods > MESH_MAX_LODS || (CurrRange->NumIndices && !CurrRange->NumLods)) {
+            return 0;
+        }
+        for(unsigned LodIdx = 0; LodIdx < CurrRange->NumLods; ++LodIdx) {
+            if((uint64_t)CurrRange->Lods[LodIdx].FirstIndex + CurrRange->Lods[LodIdx].NumIndices > CurrRange->NumIndices) {
+                return 0;
+            }
+        }
+
+        // NOTE(Jovan): Meshlets partition the full detail level only
+        uint32_t NumFullIndices = CurrRange->NumLods ? CurrRange->Lods[0].NumIndices : 0;
+        const Meshlet* Meshlets = (const Meshlet*)(image + Header->MeshletOffset) + CurrRange->FirstMeshlet;
+        for(unsigned MeshletIdx = 0; MeshletIdx < CurrRange->NumMeshlets; ++MeshletIdx) {
+            if((uint64_t)Meshlets[MeshletIdx].FirstIndex + Meshlets[MeshletIdx].NumIndices > NumFullIndices) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+int
+LoadMeshCache(const char* sourcePath, BakedModel* baked) {
+    memset(baked, 0, sizeof(BakedModel));
+    char Path[MESH_CACHE_MAX_PATH];
+    if(!CachePath(sourcePath, Path) || !PlatformMapFile(Path, &baked->File)) {
+        return LOAD_FAIL;
+    }
+
+    const unsigned char* Image = (const unsigned char*)baked->File.Data;
+    if(!ValidateImage(Image, baked->File.Size)) {
+        fprintf(stderr, "Ignoring stale or corrupt mesh cache %s.\n", Path);
+        FreeBakedModel(baked);
+        return LOAD_FAIL;
+    }
+
+    const MeshCacheHeader* Header = (const MeshCacheHeader*)Image;
+    for(unsigned SourceIdx = 0; SourceIdx < Header->Sources.NumSources; ++SourceIdx) {
+        const SourceKey* Key = &Header->Sources.Sources[SourceIdx];
+        uint64_t SourceSize;
+        int64_t SourceModifiedTime;
+        if(VfsFileStat(Key->Path, &SourceSize, &SourceModifiedTime)
+           && (SourceSize != Key->Size || SourceModifiedTime != Key->ModifiedTime)) {
+            // NOTE(Jovan): Touched but possibly unchanged source, only content decides
+            uint64_t SourceHash;
+            if(SourceSize != Key->Size || !HashSource(Key->Path, &SourceHash) || SourceHash != Key->Hash) {
+                FreeBakedModel(baked);
+                return LOAD_FAIL;
+            }
+        }
+    }
+
+    AssignPointers(baked, Image);
+    return LOAD_SUCCESS;
+}
+
+int
+WriteMeshCache(const char* sourcePath, BakedModel* baked, const ModelSources* sources) {
+    MeshCacheHeader* Header = (MeshCacheHeader*)baked->Memory;
+    char Path[MESH_CACHE_MAX_PATH], TempPath[MESH_CACHE_MAX_PATH];
+    if(!Header) {
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Keys come from the views the importer parsed, stat taken now could already describe a newer save
+    Header->Sources = *sources;
+    Header->Sources.Incomplete = 0;
+    if(sources->Incomplete || !sources->NumSources) {
+        fprintf(stderr, "Not all sources of %s are known, mesh cache could not be validated.\n", sourcePath);
+        return LOAD_FAIL;
+    }
+    if(!CachePath(sourcePath, Path)) {
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Write to side file and swap, so readers never map a partially written cache
+    memcpy(TempPath, Path, sizeof(Path));
+    strcat(TempPath, ".tmp");
+    FILE* File = fopen(TempPath, "wb");
+    if(!File) {
+        fprintf(stderr, "Failed to create mesh cache %s.\n", TempPath);
+        return LOAD_FAIL;
+    }
+
+    size_t Written = fwrite(baked->Memory, 1, (size_t)Header->FileSize, File);
+    int Closed = fclose(File) == 0;
+    if(Written != Header->FileSize || !Closed || !PlatformReplaceFile(TempPath, Path)) {
+        fprintf(stderr, "Failed to write mesh cache %s.\n", Path);
+        remove(TempPath);
+        return LOAD_FAIL;
+    }
+
+    return LOAD_SUCCESS;
+}
+
+void
+FreeBakedModel(BakedModel* baked) {
+    PlatformUnmapFile(&baked->File);
+    free(baked->Memory);
+    memset(baked, 0, sizeof(BakedModel));
+}
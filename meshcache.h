@@ -0,0 +1,134 @@
+/**
+ * @file meshcache.h
+ * @author Jovan Ivosevic
+ * @brief Baked binary mesh cache, loaded by memory mapping without parsing
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <stdint.h>
+#include "model.h"
+#include "platform.h"
+
+#define MESH_CACHE_MAGIC 0x4843534Du
+#define MESH_CACHE_VERSION 11
+#define MESH_CACHE_EXTENSION ".meshcache"
+#define MESH_CACHE_ALIGNMENT 64
+#define MESH_CACHE_MAX_PATH 512
+
+/**
+ * @brief File header. Vertex and index sections are uploaded as one buffer each, so the
+ *        dequantization transform of compact vertex formats is shared by the whole model.
+ *        Material table is uploaded as is to the material uniform buffer. Sources list every file
+ *        the import read, the model file and its material libraries alike.
+ *        Cache files are written in native byte order and are not portable between architectures.
+ *
+ */
+typedef struct MeshCacheHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t VertexStride;
+    uint32_t VertexFormat;
+    uint32_t NumMeshes;
+    uint32_t NumMaterials;
+    uint64_t FileSize;
+    uint64_t MeshTableOffset;
+    uint64_t MaterialOffset;
+    uint64_t MeshletOffset;
+    uint64_t NumMeshlets;
+    uint64_t VertexOffset;
+    uint64_t VertexBytes;
+    uint64_t IndexOffset;
+    uint64_t IndexBytes;
+    float PosScale[3];
+    float PosOffset[3];
+    ModelSources Sources;
+} MeshCacheHeader;
+
+/**
+ * @brief Location of one mesh inside the shared vertex and index sections. Index offset is in bytes,
+ *        since meshes with 16 and 32-bit indices share the index section. Index count covers
+ *        every level of detail, level ranges are relative to the first index of the mesh.
+ *
+ */
+typedef struct MeshRange {
+    uint32_t FirstVertex;
+    uint32_t NumVertices;
+    uint32_t IndexOffset;
+    uint32_t NumIndices;
+    uint32_t IndexSize;
+    uint32_t FirstMeshlet;
+    uint32_t NumMeshlets;
+    uint32_t Material;
+    uint32_t NumLods;
+    MeshLod Lods[MESH_MAX_LODS];
+    float BoundsMin[3];
+    float BoundsMax[3];
+    float Acmr;
+    float Atvr;
+} MeshRange;
+
+/**
+ * @brief Model in its final GPU layout. Points either into a mapped cache file or into
+ *        a heap image with the exact same layout as the file.
+ *
+ */
+typedef struct BakedModel {
+    const MeshCacheHeader* Header;
+    const MeshRange* Meshes;
+    const Material* Materials;
+    const Meshlet* Meshlets;
+    const unsigned char* Vertices;
+    const unsigned char* Indices;
+    MappedFile File;
+    void* Memory;
+} BakedModel;
+
+/**
+ * @brief Packs imported model data into a single cache image in memory. Vertices are
+ *        converted to VERTEX_FORMAT, with dequantization transform over model bounds stored in the header.
+ *        Indices are stored as 16-bit for meshes that fit MAX_INDEX16_VERTICES, followed by indices of simplified levels.
+ *
+ * @param data Imported model data
+ * @param baked Result, must be freed with FreeBakedModel
+ * @param profile Receives vertex conversion and index build per mesh, may be NULL. Mesh table must be sized for data.
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int BakeModelData(const ModelData* data, BakedModel* baked, LoadProfile* profile);
+
+/**
+ * @brief Maps cache file of source asset if it exists and is still valid.
+ *        Cache is valid if, for every recorded source, size and modification time match, or, failing that,
+ *        the content hash matches. Sources missing from disk are accepted as is, so caches can ship without them.
+ *
+ * @param sourcePath Source asset path, cache is expected next to it
+ * @param baked Result, must be freed with FreeBakedModel
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int LoadMeshCache(const char* sourcePath, BakedModel* baked);
+
+/**
+ * @brief Stamps baked model with source keys and writes it next to source asset.
+ *        Baked model is stamped even if the sources are incomplete, only the file is not written then.
+ *
+ * @param sourcePath Source asset path
+ * @param baked Model baked with BakeModelData
+ * @param sources Keys returned by the importer that produced the baked data
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int WriteMeshCache(const char* sourcePath, BakedModel* baked, const ModelSources* sources);
+
+/**
+ * @brief Releases mapping or memory backing baked model
+ *
+ * @param baked Baked model
+ */
+void FreeBakedModel(BakedModel* baked);
+
+#endif
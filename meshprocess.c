@@ -0,0 +1,976 @@
+#include "meshprocess.h"
+#include "hash.h"
+#include "jobs.h"
+#include "loadprofile.h"
+#include "platform.h"
+#include "simplify.h"
+#include "tangentspace.h"
+#include "cglm/cglm.h"
+
+#include <math.h>
+#include <string.h>
+
+#define FLOATS_PER_VERTEX (sizeof(Vertex) / sizeof(float))
+#define FORSYTH_MAX_VALENCE 32
+#define OVERDRAW_MIN_CLUSTER 32
+
+typedef struct MeshStats {
+    unsigned VerticesBefore;
+    unsigned VerticesAfter;
+    float AcmrBefore;
+    float AtvrBefore;
+    float AcmrAfter;
+    float AtvrAfter;
+    int Failed;
+} MeshStats;
+
+typedef struct ProcessContext {
+    ModelData* Data;
+    MeshStats* Stats;
+} ProcessContext;
+
+/**
+ * @brief Builds comparison key of vertex. Bit pattern for exact welding, grid cell otherwise.
+ *
+ */
+static void
+VertexKey(const Vertex* vertex, float epsilon, int64_t* key) {
+    const float* Components = (const float*)vertex;
+    for(unsigned ComponentIdx = 0; ComponentIdx < FLOATS_PER_VERTEX; ++ComponentIdx) {
+        if(epsilon > 0.0f) {
+            key[ComponentIdx] = (int64_t)floor(Components[ComponentIdx] / epsilon + 0.5);
+        } else {
+            uint32_t Bits;
+            memcpy(&Bits, &Components[ComponentIdx], sizeof(Bits));
+            key[ComponentIdx] = Bits;
+        }
+    }
+}
+
+int
+WeldMeshVertices(MeshData* mesh, float epsilon) {
+    if(!mesh->NumIndices || mesh->NumVertices < 2) {
+        return LOAD_SUCCESS;
+    }
+
+    unsigned TableSize = 1;
+    while(TableSize < mesh->NumVertices * 2) {
+        TableSize <<= 1;
+    }
+
+    int64_t* Keys = (int64_t*)malloc((size_t)mesh->NumVertices * FLOATS_PER_VERTEX * sizeof(int64_t));
+    unsigned* Table = (unsigned*)malloc(TableSize * sizeof(unsigned));
+    unsigned* Remap = (unsigned*)malloc(mesh->NumVertices * sizeof(unsigned));
+    if(!Keys || !Table || !Remap) {
+        fprintf(stderr, "Failed to allocate weld tables.\n");
+        free(Keys);
+        free(Table);
+        free(Remap);
+        return LOAD_FAIL;
+    }
+
+    memset(Table, 0xFF, TableSize * sizeof(unsigned));
+    size_t KeySize = FLOATS_PER_VERTEX * sizeof(int64_t);
+    unsigned NumUnique = 0;
+    for(unsigned VertIdx = 0; VertIdx < mesh->NumVertices; ++VertIdx) {
+        int64_t* Key = &Keys[VertIdx * FLOATS_PER_VERTEX];
+        VertexKey(&mesh->Vertices[VertIdx], epsilon, Key);
+
+        // NOTE(Jovan): Open addressing with linear probing, table is at most half full
+        unsigned Slot = (unsigned)HashBytes(Key, KeySize, 0) & (TableSize - 1);
+        while(Table[Slot] != ~0u && memcmp(&Keys[Table[Slot] * FLOATS_PER_VERTEX], Key, KeySize)) {
+            Slot = (Slot + 1) & (TableSize - 1);
+        }
+
+        if(Table[Slot] == ~0u) {
+            // NOTE(Jovan): Unique vertices keep first-occurrence order, so compaction can run in place
+            Table[Slot] = VertIdx;
+            Remap[VertIdx] = NumUnique;
+            mesh->Vertices[NumUnique++] = mesh->Vertices[VertIdx];
+        } else {
+            Remap[VertIdx] = Remap[Table[Slot]];
+        }
+    }
+
+    for(unsigned Idx = 0; Idx < mesh->NumIndices; ++Idx) {
+        mesh->Indices[Idx] = Remap[mesh->Indices[Idx]];
+    }
+
+    mesh->NumVertices = NumUnique;
+    free(Keys);
+    free(Table);
+    free(Remap);
+    return LOAD_SUCCESS;
+}
+
+void
+AnalyzeVertexCache(const unsigned* indices, unsigned numIndices, unsigned numVertices,
+                   unsigned cacheSize, float* acmr, float* atvr) {
+    *acmr = 0.0f;
+    *atvr = 0.0f;
+    unsigned* InsertTime = (unsigned*)malloc((numVertices ? numVertices : 1) * sizeof(unsigned));
+    if(!InsertTime || numIndices < 3) {
+        free(InsertTime);
+        return;
+    }
+
+    // NOTE(Jovan): Vertex is in FIFO if it was inserted within the last cacheSize insertions
+    memset(InsertTime, 0, numVertices * sizeof(unsigned));
+    unsigned Time = cacheSize + 1;
+    unsigned Misses = 0;
+    for(unsigned Idx = 0; Idx < numIndices; ++Idx) {
+        unsigned VertIdx = indices[Idx];
+        if(Time - InsertTime[VertIdx] > cacheSize) {
+            InsertTime[VertIdx] = Time++;
+            ++Misses;
+        }
+    }
+
+    *acmr = (float)Misses / (float)(numIndices / 3);
+    *atvr = numVertices ? (float)Misses / (float)numVertices : 0.0f;
+    free(InsertTime);
+}
+
+static float sCacheScores[FORSYTH_CACHE_SIZE + 1];
+static float sValenceScores[FORSYTH_MAX_VALENCE + 1];
+static volatile long sScoreTablesReady;
+
+static void
+InitScoreTables(void) {
+    // NOTE(Jovan): Tables are deterministic, racing writers store identical values
+    if(AtomicLoad(&sScoreTablesReady)) {
+        return;
+    }
+
+    for(unsigned Position = 0; Position < FORSYTH_CACHE_SIZE; ++Position) {
+        // NOTE(Jovan): Last triangle's vertices score the same regardless of order, so a triangle is not favoured over its neighbours
+        sCacheScores[Position] = Position < 3
+            ? 0.75f
+            : powf(1.0f - (float)(Position - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+    }
+    sCacheScores[FORSYTH_CACHE_SIZE] = 0.0f;
+
+    sValenceScores[0] = 0.0f;
+    for(unsigned Valence = 1; Valence <= FORSYTH_MAX_VALENCE; ++Valence) {
+        sValenceScores[Valence] = 2.0f / sqrtf((float)Valence);
+    }
+    AtomicStore(&sScoreTablesReady, 1);
+}
+
+static float
+VertexScore(int cachePosition, unsigned liveTriangles) {
+    if(!liveTriangles) {
+        return -1.0f;
+    }
+
+    float Score = cachePosition < 0 ? 0.0f : sCacheScores[cachePosition];
+    return Score + sValenceScores[liveTriangles < FORSYTH_MAX_VALENCE ? liveTriangles : FORSYTH_MAX_VALENCE];
+}
+
+int
+OptimizeVertexCache(MeshData* mesh) {
+    unsigned NumTriangles = mesh->NumIndices / 3;
+    unsigned NumVertices = mesh->NumVertices;
+    if(NumTriangles < 2) {
+        return LOAD_SUCCESS;
+    }
+
+    InitScoreTables();
+    unsigned* LiveTriangles = (unsigned*)calloc(NumVertices, sizeof(unsigned));
+    unsigned* AdjacencyOffsets = (unsigned*)malloc((NumVertices + 1) * sizeof(unsigned));
+    unsigned* Adjacency = (unsigned*)malloc((size_t)NumTriangles * 3 * sizeof(unsigned));
+    float* VertexScores = (float*)malloc(NumVertices * sizeof(float));
+    float* TriangleScores = (float*)malloc(NumTriangles * sizeof(float));
+    unsigned char* Emitted = (unsigned char*)calloc(NumTriangles, 1);
+    unsigned* Output = (unsigned*)malloc((size_t)NumTriangles * 3 * sizeof(unsigned));
+    if(!LiveTriangles || !AdjacencyOffsets || !Adjacency || !VertexScores
+       || !TriangleScores || !Emitted || !Output) {
+        fprintf(stderr, "Failed to allocate vertex cache optimizer tables.\n");
+        free(LiveTriangles);
+        free(AdjacencyOffsets);
+        free(Adjacency);
+        free(VertexScores);
+        free(TriangleScores);
+        free(Emitted);
+        free(Output);
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Per vertex lists of triangles that use it, live ones are kept at the front
+    const unsigned* Indices = mesh->Indices;
+    for(unsigned Idx = 0; Idx < NumTriangles * 3; ++Idx) {
+        ++LiveTriangles[Indices[Idx]];
+    }
+    AdjacencyOffsets[0] = 0;
+    for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+        AdjacencyOffsets[VertIdx + 1] = AdjacencyOffsets[VertIdx] + LiveTriangles[VertIdx];
+        LiveTriangles[VertIdx] = 0;
+    }
+    for(unsigned TriIdx = 0; TriIdx < NumTriangles; ++TriIdx) {
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            unsigned VertIdx = Indices[TriIdx * 3 + Corner];
+            Adjacency[AdjacencyOffsets[VertIdx] + LiveTriangles[VertIdx]++] = TriIdx;
+        }
+    }
+
+    for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+        VertexScores[VertIdx] = VertexScore(-1, LiveTriangles[VertIdx]);
+    }
+
+    int BestTriangle = -1;
+    float BestScore = -1.0f;
+    for(unsigned TriIdx = 0; TriIdx < NumTriangles; ++TriIdx) {
+        const unsigned* Triangle = &Indices[TriIdx * 3];
+        TriangleScores[TriIdx] = VertexScores[Triangle[0]] + VertexScores[Triangle[1]] + VertexScores[Triangle[2]];
+        if(TriangleScores[TriIdx] > BestScore) {
+            BestScore = TriangleScores[TriIdx];
+            BestTriangle = (int)TriIdx;
+        }
+    }
+
+    unsigned Cache[FORSYTH_CACHE_SIZE + 3];
+    unsigned NewCache[FORSYTH_CACHE_SIZE + 3];
+    unsigned CacheCount = 0;
+    unsigned InputCursor = 0;
+    for(unsigned NumEmitted = 0; NumEmitted < NumTriangles; ++NumEmitted) {
+        if(BestTriangle < 0) {
+            // NOTE(Jovan): Dead end, nothing in cache has live triangles. Next unemitted one in input order keeps this linear
+            while(Emitted[InputCursor]) {
+                ++InputCursor;
+            }
+            BestTriangle = (int)InputCursor;
+        }
+
+        const unsigned* Triangle = &Indices[BestTriangle * 3];
+        Emitted[BestTriangle] = 1;
+        memcpy(&Output[NumEmitted * 3], Triangle, 3 * sizeof(unsigned));
+
+        unsigned NewCount = 0;
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            unsigned VertIdx = Triangle[Corner];
+            NewCache[NewCount++] = VertIdx;
+
+            unsigned* Begin = &Adjacency[AdjacencyOffsets[VertIdx]];
+            unsigned* Last = Begin + --LiveTriangles[VertIdx];
+            for(unsigned* Slot = Begin; Slot <= Last; ++Slot) {
+                if(*Slot == (unsigned)BestTriangle) {
+                    *Slot = *Last;
+                    *Last = (unsigned)BestTriangle;
+                    break;
+                }
+            }
+        }
+
+        for(unsigned CacheIdx = 0; CacheIdx < CacheCount; ++CacheIdx) {
+            unsigned VertIdx = Cache[CacheIdx];
+            if(VertIdx != Triangle[0] && VertIdx != Triangle[1] && VertIdx != Triangle[2]) {
+                NewCache[NewCount++] = VertIdx;
+            }
+        }
+
+        // NOTE(Jovan): Rescore every vertex whose cache position changed, including the ones just pushed out
+        BestTriangle = -1;
+        BestScore = -1.0f;
+        for(unsigned CacheIdx = 0; CacheIdx < NewCount; ++CacheIdx) {
+            unsigned VertIdx = NewCache[CacheIdx];
+            int Position = CacheIdx < FORSYTH_CACHE_SIZE ? (int)CacheIdx : -1;
+            float Score = VertexScore(Position, LiveTriangles[VertIdx]);
+            float Delta = Score - VertexScores[VertIdx];
+            VertexScores[VertIdx] = Score;
+
+            const unsigned* Begin = &Adjacency[AdjacencyOffsets[VertIdx]];
+            for(unsigned AdjIdx = 0; AdjIdx < LiveTriangles[VertIdx]; ++AdjIdx) {
+                unsigned TriIdx = Begin[AdjIdx];
+                TriangleScores[TriIdx] += Delta;
+                if(Position >= 0 && TriangleScores[TriIdx] > BestScore) {
+                    BestScore = TriangleScores[TriIdx];
+                    BestTriangle = (int)TriIdx;
+                }
+            }
+        }
+
+        CacheCount = NewCount < FORSYTH_CACHE_SIZE ? NewCount : FORSYTH_CACHE_SIZE;
+        memcpy(Cache, NewCache, CacheCount * sizeof(unsigned));
+    }
+
+    memcpy(mesh->Indices, Output, (size_t)NumTriangles * 3 * sizeof(unsigned));
+    free(LiveTriangles);
+    free(AdjacencyOffsets);
+    free(Adjacency);
+    free(VertexScores);
+    free(TriangleScores);
+    free(Emitted);
+    free(Output);
+    return LOAD_SUCCESS;
+}
+
+typedef struct TriangleCluster {
+    unsigned FirstTriangle;
+    unsigned NumTriangles;
+    float SortKey;
+} TriangleCluster;
+
+static int
+CompareClusters(const void* a, const void* b) {
+    const TriangleCluster* ClusterA = (const TriangleCluster*)a;
+    const TriangleCluster* ClusterB = (const TriangleCluster*)b;
+    if(ClusterA->SortKey != ClusterB->SortKey) {
+        return ClusterA->SortKey > ClusterB->SortKey ? -1 : 1;
+    }
+    // NOTE(Jovan): qsort is not stable, ties keep cache order explicitly
+    return ClusterA->FirstTriangle < ClusterB->FirstTriangle ? -1 : 1;
+}
+
+int
+OptimizeOverdraw(MeshData* mesh) {
+    unsigned NumTriangles = mesh->NumIndices / 3;
+    if(NumTriangles < 2 * OVERDRAW_MIN_CLUSTER) {
+        return LOAD_SUCCESS;
+    }
+
+    TriangleCluster* Clusters = (TriangleCluster*)malloc(NumTriangles * sizeof(TriangleCluster));
+    unsigned* InsertTime = (unsigned*)calloc(mesh->NumVertices, sizeof(unsigned));
+    unsigned* Output = (unsigned*)malloc((size_t)NumTriangles * 3 * sizeof(unsigned));
+    if(!Clusters || !InsertTime || !Output) {
+        fprintf(stderr, "Failed to allocate overdraw optimizer tables.\n");
+        free(Clusters);
+        free(InsertTime);
+        free(Output);
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Triangle that misses on every corner starts from an effectively cold cache,
+    // cutting there costs almost nothing in ACMR
+    const unsigned* Indices = mesh->Indices;
+    unsigned Time = ANALYZE_CACHE_SIZE + 1;
+    unsigned NumClusters = 0;
+    for(unsigned TriIdx = 0; TriIdx < NumTriangles; ++TriIdx) {
+        unsigned Misses = 0;
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            unsigned VertIdx = Indices[TriIdx * 3 + Corner];
+            if(Time - InsertTime[VertIdx] > ANALYZE_CACHE_SIZE) {
+                InsertTime[VertIdx] = Time++;
+                ++Misses;
+            }
+        }
+
+        if(!NumClusters || (Misses == 3 && Clusters[NumClusters - 1].NumTriangles >= OVERDRAW_MIN_CLUSTER)) {
+            Clusters[NumClusters].FirstTriangle = TriIdx;
+            Clusters[NumClusters].NumTriangles = 0;
+            ++NumClusters;
+        }
+        ++Clusters[NumClusters - 1].NumTriangles;
+    }
+
+    if(NumClusters < 2) {
+        free(Clusters);
+        free(InsertTime);
+        free(Output);
+        return LOAD_SUCCESS;
+    }
+
+    float MeshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    for(unsigned VertIdx = 0; VertIdx < mesh->NumVertices; ++VertIdx) {
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            MeshCentroid[Axis] += mesh->Vertices[VertIdx].Position[Axis];
+        }
+    }
+    for(unsigned Axis = 0; Axis < 3; ++Axis) {
+        MeshCentroid[Axis] /= (float)(mesh->NumVertices ? mesh->NumVertices : 1);
+    }
+
+    // NOTE(Jovan): Clusters facing away from the mesh center occlude the rest from most directions, draw them first
+    for(unsigned ClusterIdx = 0; ClusterIdx < NumClusters; ++ClusterIdx) {
+        TriangleCluster* Cluster = &Clusters[ClusterIdx];
+        float Centroid[3] = { 0.0f, 0.0f, 0.0f };
+        float Normal[3] = { 0.0f, 0.0f, 0.0f };
+        float Area = 0.0f;
+        for(unsigned TriIdx = Cluster->FirstTriangle; TriIdx < Cluster->FirstTriangle + Cluster->NumTriangles; ++TriIdx) {
+            const float* P0 = mesh->Vertices[Indices[TriIdx * 3 + 0]].Position;
+            const float* P1 = mesh->Vertices[Indices[TriIdx * 3 + 1]].Position;
+            const float* P2 = mesh->Vertices[Indices[TriIdx * 3 + 2]].Position;
+            float E1[3] = { P1[0] - P0[0], P1[1] - P0[1], P1[2] - P0[2] };
+            float E2[3] = { P2[0] - P0[0], P2[1] - P0[1], P2[2] - P0[2] };
+            float Cross[3] = {
+                E1[1] * E2[2] - E1[2] * E2[1],
+                E1[2] * E2[0] - E1[0] * E2[2],
+                E1[0] * E2[1] - E1[1] * E2[0]
+            };
+            float TriangleArea = sqrtf(Cross[0] * Cross[0] + Cross[1] * Cross[1] + Cross[2] * Cross[2]);
+            for(unsigned Axis = 0; Axis < 3; ++Axis) {
+                Normal[Axis] += Cross[Axis];
+                Centroid[Axis] += (P0[Axis] + P1[Axis] + P2[Axis]) / 3.0f * TriangleArea;
+            }
+            Area += TriangleArea;
+        }
+
+        float NormalLength = sqrtf(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+        Cluster->SortKey = 0.0f;
+        if(Area > 0.0f && NormalLength > 0.0f) {
+            for(unsigned Axis = 0; Axis < 3; ++Axis) {
+                Cluster->SortKey += (Centroid[Axis] / Area - MeshCentroid[Axis]) * Normal[Axis] / NormalLength;
+            }
+        }
+    }
+
+    qsort(Clusters, NumClusters, sizeof(TriangleCluster), CompareClusters);
+    unsigned NumWritten = 0;
+    for(unsigned ClusterIdx = 0; ClusterIdx < NumClusters; ++ClusterIdx) {
+        const TriangleCluster* Cluster = &Clusters[ClusterIdx];
+        memcpy(&Output[NumWritten], &Indices[Cluster->FirstTriangle * 3], (size_t)Cluster->NumTriangles * 3 * sizeof(unsigned));
+        NumWritten += Cluster->NumTriangles * 3;
+    }
+
+    float AcmrBefore, AcmrAfter, Atvr;
+    AnalyzeVertexCache(mesh->Indices, mesh->NumIndices, mesh->NumVertices, ANALYZE_CACHE_SIZE, &AcmrBefore, &Atvr);
+    AnalyzeVertexCache(Output, NumWritten, mesh->NumVertices, ANALYZE_CACHE_SIZE, &AcmrAfter, &Atvr);
+    if(AcmrAfter <= AcmrBefore * OVERDRAW_ACMR_THRESHOLD) {
+        memcpy(mesh->Indices, Output, NumWritten * sizeof(unsigned));
+    }
+
+    free(Clusters);
+    free(InsertTime);
+    free(Output);
+    return LOAD_SUCCESS;
+}
+
+int
+OptimizeVertexFetch(MeshData* mesh) {
+    if(!mesh->NumIndices || !mesh->NumVertices) {
+        return LOAD_SUCCESS;
+    }
+
+    unsigned* Remap = (unsigned*)malloc(mesh->NumVertices * sizeof(unsigned));
+    Vertex* Vertices = (Vertex*)malloc(mesh->NumVertices * sizeof(Vertex));
+    if(!Remap || !Vertices) {
+        fprintf(stderr, "Failed to allocate vertex fetch optimizer tables.\n");
+        free(Remap);
+        free(Vertices);
+        return LOAD_FAIL;
+    }
+
+    memset(Remap, 0xFF, mesh->NumVertices * sizeof(unsigned));
+    unsigned NumUsed = 0;
+    for(unsigned Idx = 0; Idx < mesh->NumIndices; ++Idx) {
+        unsigned VertIdx = mesh->Indices[Idx];
+        if(Remap[VertIdx] == ~0u) {
+            Vertices[NumUsed] = mesh->Vertices[VertIdx];
+            Remap[VertIdx] = NumUsed++;
+        }
+        mesh->Indices[Idx] = Remap[VertIdx];
+    }
+
+    // NOTE(Jovan): Vertices no index refers to are dropped
+    memcpy(mesh->Vertices, Vertices, NumUsed * sizeof(Vertex));
+    mesh->NumVertices = NumUsed;
+    free(Remap);
+    free(Vertices);
+    return LOAD_SUCCESS;
+}
+
+/**
+ * @brief Finds triangle ranges of mesh that each reference at most MAX_INDEX16_VERTICES vertices
+ *
+ */
+static unsigned
+FindSplitRanges(const MeshData* mesh, unsigned* partOf, unsigned* firstTriangles) {
+    unsigned NumTriangles = mesh->NumIndices / 3;
+    unsigned NumParts = 0;
+    unsigned PartVertices = MAX_INDEX16_VERTICES + 1;
+    memset(partOf, 0xFF, mesh->NumVertices * sizeof(unsigned));
+    for(unsigned TriIdx = 0; TriIdx < NumTriangles; ++TriIdx) {
+        const unsigned* Triangle = &mesh->Indices[TriIdx * 3];
+        unsigned NewVertices = 0;
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            NewVertices += partOf[Triangle[Corner]] != NumParts - 1
+                && (Corner < 1 || Triangle[Corner] != Triangle[0])
+                && (Corner < 2 || Triangle[Corner] != Triangle[1]);
+        }
+
+        if(PartVertices + NewVertices > MAX_INDEX16_VERTICES) {
+            if(firstTriangles) {
+                firstTriangles[NumParts] = TriIdx;
+            }
+            ++NumParts;
+            PartVertices = 0;
+            NewVertices = 3 - (Triangle[1] == Triangle[0]) - (Triangle[2] == Triangle[0] || Triangle[2] == Triangle[1]);
+        }
+
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            partOf[Triangle[Corner]] = NumParts - 1;
+        }
+        PartVertices += NewVertices;
+    }
+
+    return NumParts;
+}
+
+/**
+ * @brief Builds one split part, vertices keep the first-use order of the source mesh
+ *
+ */
+static int
+BuildSplitPart(Arena* staging, const MeshData* mesh, unsigned firstTriangle, unsigned numTriangles, unsigned* localIndex, MeshData* part) {
+    memset(part, 0, sizeof(MeshData));
+    part->Indices = (unsigned*)ArenaAlloc(staging, (size_t)numTriangles * 3 * sizeof(unsigned));
+    part->Vertices = (Vertex*)ArenaAlloc(staging, (size_t)(numTriangles * 3 < MAX_INDEX16_VERTICES ? numTriangles * 3 : MAX_INDEX16_VERTICES) * sizeof(Vertex));
+    if(!part->Indices || !part->Vertices) {
+        return LOAD_FAIL;
+    }
+
+    const unsigned* Source = &mesh->Indices[firstTriangle * 3];
+    for(unsigned Idx = 0; Idx < numTriangles * 3; ++Idx) {
+        localIndex[Source[Idx]] = ~0u;
+    }
+    for(unsigned Idx = 0; Idx < numTriangles * 3; ++Idx) {
+        unsigned VertIdx = Source[Idx];
+        if(localIndex[VertIdx] == ~0u) {
+            localIndex[VertIdx] = part->NumVertices;
+            part->Vertices[part->NumVertices++] = mesh->Vertices[VertIdx];
+        }
+        part->Indices[Idx] = localIndex[VertIdx];
+    }
+
+    part->NumIndices = numTriangles * 3;
+    part->Material = mesh->Material;
+    // NOTE(Jovan): Parts share processing time of their source by triangle count
+    part->ProcessSeconds = mesh->NumIndices ? mesh->ProcessSeconds * part->NumIndices / mesh->NumIndices : 0.0;
+    AnalyzeVertexCache(part->Indices, part->NumIndices, part->NumVertices, ANALYZE_CACHE_SIZE, &part->Acmr, &part->Atvr);
+    return LOAD_SUCCESS;
+}
+
+int
+SplitLargeMeshes(ModelData* data) {
+    unsigned MaxVertices = 0;
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        if(CurrMesh->NumIndices && CurrMesh->NumVertices > MaxVertices) {
+            MaxVertices = CurrMesh->NumVertices;
+        }
+    }
+    if(MaxVertices <= MAX_INDEX16_VERTICES) {
+        return LOAD_SUCCESS;
+    }
+
+    unsigned* PartOf = (unsigned*)malloc(MaxVertices * sizeof(unsigned));
+    unsigned* NumParts = (unsigned*)malloc(data->NumMeshes * sizeof(unsigned));
+    if(!PartOf || !NumParts) {
+        fprintf(stderr, "Failed to allocate mesh split tables.\n");
+        free(PartOf);
+        free(NumParts);
+        return LOAD_FAIL;
+    }
+
+    unsigned TotalParts = 0;
+    unsigned MaxParts = 0;
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        NumParts[MeshIdx] = CurrMesh->NumIndices && CurrMesh->NumVertices > MAX_INDEX16_VERTICES
+            ? FindSplitRanges(CurrMesh, PartOf, NULL)
+            : 1;
+        TotalParts += NumParts[MeshIdx];
+        if(NumParts[MeshIdx] > MaxParts) {
+            MaxParts = NumParts[MeshIdx];
+        }
+    }
+
+    MeshData* Meshes = (MeshData*)ArenaAlloc(&data->Staging, TotalParts * sizeof(MeshData));
+    unsigned* FirstTriangles = (unsigned*)malloc(MaxParts * sizeof(unsigned));
+    if(!Meshes || !FirstTriangles) {
+        fprintf(stderr, "Failed to allocate split meshes.\n");
+        free(FirstTriangles);
+        free(PartOf);
+        free(NumParts);
+        return LOAD_FAIL;
+    }
+
+    unsigned NumMeshes = 0;
+    int Result = LOAD_SUCCESS;
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        if(NumParts[MeshIdx] == 1 || !Result) {
+            Meshes[NumMeshes++] = *CurrMesh;
+            memset(CurrMesh, 0, sizeof(MeshData));
+            continue;
+        }
+
+        FindSplitRanges(CurrMesh, PartOf, FirstTriangles);
+        unsigned NumTriangles = CurrMesh->NumIndices / 3;
+        for(unsigned PartIdx = 0; PartIdx < NumParts[MeshIdx] && Result; ++PartIdx) {
+            unsigned LastTriangle = PartIdx + 1 < NumParts[MeshIdx] ? FirstTriangles[PartIdx + 1] : NumTriangles;
+            Result = BuildSplitPart(&data->Staging, CurrMesh, FirstTriangles[PartIdx], LastTriangle - FirstTriangles[PartIdx],
+                                    PartOf, &Meshes[NumMeshes]);
+            NumMeshes += Result;
+        }
+        fprintf(stdout, "Mesh %u: split into %u parts for 16-bit indices.\n", MeshIdx, NumParts[MeshIdx]);
+    }
+
+    // NOTE(Jovan): Source meshes and the old table stay in the arena until the model data is freed
+    if(!Result) {
+        fprintf(stderr, "Failed to split large meshes.\n");
+    } else {
+        // NOTE(Jovan): Material table stays with the model, only the mesh array is replaced
+        data->Meshes = Meshes;
+        data->NumMeshes = NumMeshes;
+    }
+
+    free(FirstTriangles);
+    free(PartOf);
+    free(NumParts);
+    return Result;
+}
+
+static void
+ComputeMeshletBounds(const MeshData* mesh, Meshlet* meshlet) {
+    const unsigned* Indices = &mesh->Indices[meshlet->FirstIndex];
+    vec3 Box[2];
+    glm_aabb_invalidate(Box);
+    for(unsigned Idx = 0; Idx < meshlet->NumIndices; ++Idx) {
+        float* Position = (float*)mesh->Vertices[Indices[Idx]].Position;
+        glm_vec3_minv(Box[0], Position, Box[0]);
+        glm_vec3_maxv(Box[1], Position, Box[1]);
+    }
+
+    glm_vec3_copy(Box[0], meshlet->BoundsMin);
+    glm_vec3_copy(Box[1], meshlet->BoundsMax);
+    glm_aabb_center(Box, meshlet->Sphere);
+    float RadiusSquared = 0.0f;
+    for(unsigned Idx = 0; Idx < meshlet->NumIndices; ++Idx) {
+        float Distance = glm_vec3_distance2(meshlet->Sphere, (float*)mesh->Vertices[Indices[Idx]].Position);
+        RadiusSquared = Distance > RadiusSquared ? Distance : RadiusSquared;
+    }
+    meshlet->Sphere[3] = sqrtf(RadiusSquared);
+
+    vec3 Axis = { 0.0f, 0.0f, 0.0f };
+    for(unsigned Idx = 0; Idx < meshlet->NumIndices; Idx += 3) {
+        vec3 Edge1, Edge2, Normal;
+        glm_vec3_sub((float*)mesh->Vertices[Indices[Idx + 1]].Position, (float*)mesh->Vertices[Indices[Idx]].Position, Edge1);
+        glm_vec3_sub((float*)mesh->Vertices[Indices[Idx + 2]].Position, (float*)mesh->Vertices[Indices[Idx]].Position, Edge2);
+        glm_vec3_cross(Edge1, Edge2, Normal);
+        glm_vec3_normalize(Normal);
+        glm_vec3_add(Axis, Normal, Axis);
+    }
+    glm_vec3_normalize(Axis);
+    glm_vec3_copy(Axis, meshlet->ConeAxis);
+
+    float MinDot = 1.0f;
+    for(unsigned Idx = 0; Idx < meshlet->NumIndices && MinDot > 0.0f; Idx += 3) {
+        vec3 Edge1, Edge2, Normal;
+        glm_vec3_sub((float*)mesh->Vertices[Indices[Idx + 1]].Position, (float*)mesh->Vertices[Indices[Idx]].Position, Edge1);
+        glm_vec3_sub((float*)mesh->Vertices[Indices[Idx + 2]].Position, (float*)mesh->Vertices[Indices[Idx]].Position, Edge2);
+        glm_vec3_cross(Edge1, Edge2, Normal);
+        if(glm_vec3_norm2(Normal) == 0.0f) {
+            continue;
+        }
+        glm_vec3_normalize(Normal);
+        float Dot = glm_vec3_dot(Axis, Normal);
+        MinDot = Dot < MinDot ? Dot : MinDot;
+    }
+
+    // NOTE(Jovan): Normals spread over a hemisphere or more can face the camera from any side
+    meshlet->ConeCutoff = MinDot <= 0.0f || glm_vec3_norm2(Axis) == 0.0f ? 1.0f : sqrtf(1.0f - MinDot * MinDot);
+}
+
+int
+BuildMeshlets(MeshData* mesh, Arena* staging) {
+    mesh->Meshlets = NULL;
+    mesh->NumMeshlets = 0;
+    unsigned NumTriangles = mesh->NumIndices / 3;
+    if(!NumTriangles) {
+        return LOAD_SUCCESS;
+    }
+
+    unsigned* MeshletOf = (unsigned*)malloc(mesh->NumVertices * sizeof(unsigned));
+    if(!MeshletOf) {
+        fprintf(stderr, "Failed to allocate meshlet tables.\n");
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Triangles are already in cache order, so consecutive runs are compact clusters.
+    // First pass only counts, second one fills.
+    Meshlet* Meshlets = NULL;
+    unsigned NumMeshlets = 0;
+    for(unsigned Pass = 0; Pass < 2; ++Pass) {
+        memset(MeshletOf, 0xFF, mesh->NumVertices * sizeof(unsigned));
+        unsigned MeshletVertices = 0, MeshletTriangles = MESHLET_MAX_TRIANGLES;
+        vec3 ConeSum = { 0.0f, 0.0f, 0.0f };
+        NumMeshlets = 0;
+        for(unsigned TriIdx = 0; TriIdx < NumTriangles; ++TriIdx) {
+            const unsigned* Triangle = &mesh->Indices[TriIdx * 3];
+            unsigned NewVertices = (MeshletOf[Triangle[0]] != NumMeshlets - 1)
+                + (MeshletOf[Triangle[1]] != NumMeshlets - 1 && Triangle[1] != Triangle[0])
+                + (MeshletOf[Triangle[2]] != NumMeshlets - 1 && Triangle[2] != Triangle[0] && Triangle[2] != Triangle[1]);
+            // NOTE(Jovan): Cutting where normals turn away keeps cones narrow enough to be culled
+            vec3 Edge1, Edge2, Normal;
+            glm_vec3_sub((float*)mesh->Vertices[Triangle[1]].Position, (float*)mesh->Vertices[Triangle[0]].Position, Edge1);
+            glm_vec3_sub((float*)mesh->Vertices[Triangle[2]].Position, (float*)mesh->Vertices[Triangle[0]].Position, Edge2);
+            glm_vec3_cross(Edge1, Edge2, Normal);
+            glm_vec3_normalize(Normal);
+            vec3 Axis;
+            glm_vec3_normalize_to(ConeSum, Axis);
+            int Diverges = MeshletTriangles && glm_vec3_norm2(Normal) > 0.0f && glm_vec3_dot(Axis, Normal) < MESHLET_CONE_SPLIT;
+            if(MeshletTriangles == MESHLET_MAX_TRIANGLES || MeshletVertices + NewVertices > MESHLET_MAX_VERTICES || Diverges) {
+                if(Meshlets) {
+                    Meshlets[NumMeshlets].FirstIndex = TriIdx * 3;
+                }
+                ++NumMeshlets;
+                MeshletVertices = 0;
+                MeshletTriangles = 0;
+                glm_vec3_zero(ConeSum);
+                NewVertices = 1 + (Triangle[1] != Triangle[0]) + (Triangle[2] != Triangle[0] && Triangle[2] != Triangle[1]);
+            }
+
+            for(unsigned Corner = 0; Corner < 3; ++Corner) {
+                MeshletOf[Triangle[Corner]] = NumMeshlets - 1;
+            }
+            glm_vec3_add(ConeSum, Normal, ConeSum);
+            MeshletVertices += NewVertices;
+            ++MeshletTriangles;
+            if(Meshlets) {
+                Meshlets[NumMeshlets - 1].NumIndices = MeshletTriangles * 3;
+            }
+        }
+
+        // NOTE(Jovan): Second pass and the bounds write every field, so the arena block needs no clearing
+        if(!Meshlets) {
+            Meshlets = (Meshlet*)ArenaAlloc(staging, NumMeshlets * sizeof(Meshlet));
+            if(!Meshlets) {
+                fprintf(stderr, "Failed to allocate meshlets.\n");
+                free(MeshletOf);
+                return LOAD_FAIL;
+            }
+        }
+    }
+
+    for(unsigned MeshletIdx = 0; MeshletIdx < NumMeshlets; ++MeshletIdx) {
+        ComputeMeshletBounds(mesh, &Meshlets[MeshletIdx]);
+    }
+
+    mesh->Meshlets = Meshlets;
+    mesh->NumMeshlets = NumMeshlets;
+    free(MeshletOf);
+    return LOAD_SUCCESS;
+}
+
+static const float sLodTriangleRatios[MESH_MAX_LODS - 1] = { 0.5f, 0.25f, 0.1f };
+
+int
+BuildMeshLods(MeshData* mesh, Arena* staging) {
+    mesh->LodIndices = NULL;
+    mesh->NumLodIndices = 0;
+    mesh->NumLods = 0;
+    if(!mesh->NumIndices) {
+        return LOAD_SUCCESS;
+    }
+
+    mesh->Lods[0].FirstIndex = 0;
+    mesh->Lods[0].NumIndices = mesh->NumIndices;
+    mesh->Lods[0].Error = 0.0f;
+    mesh->NumLods = 1;
+
+    // NOTE(Jovan): Every level is at most as large as the full one, so one scratch buffer per level suffices
+    unsigned* LodIndices = (unsigned*)malloc((size_t)mesh->NumIndices * (MESH_MAX_LODS - 1) * sizeof(unsigned));
+    if(!LodIndices) {
+        fprintf(stderr, "Failed to allocate level of detail indices.\n");
+        return LOAD_FAIL;
+    }
+
+    const unsigned* Source = mesh->Indices;
+    unsigned NumSource = mesh->NumIndices;
+    unsigned NumLodIndices = 0;
+    for(unsigned LodIdx = 1; LodIdx < MESH_MAX_LODS; ++LodIdx) {
+        unsigned Target = (unsigned)((float)(mesh->NumIndices / 3) * sLodTriangleRatios[LodIdx - 1]) * 3;
+        if(Target < 3) {
+            break;
+        }
+
+        unsigned* Destination = &LodIndices[NumLodIndices];
+        unsigned NumDestination;
+        float Error;
+        if(!SimplifyMesh(mesh, Source, NumSource, Target, Destination, &NumDestination, &Error)) {
+            free(LodIndices);
+            mesh->NumLods = 1;
+            return LOAD_FAIL;
+        }
+        // NOTE(Jovan): Locked seams and borders can keep the mesh from shrinking, such a level isn't worth its memory
+        if(!NumDestination || (float)NumDestination > (float)NumSource * LOD_MIN_REDUCTION) {
+            break;
+        }
+
+        MeshData Level = *mesh;
+        Level.Indices = Destination;
+        Level.NumIndices = NumDestination;
+        if(!OptimizeVertexCache(&Level)) {
+            free(LodIndices);
+            mesh->NumLods = 1;
+            return LOAD_FAIL;
+        }
+
+        MeshLod* Lod = &mesh->Lods[mesh->NumLods++];
+        Lod->FirstIndex = mesh->NumIndices + NumLodIndices;
+        Lod->NumIndices = NumDestination;
+        Lod->Error = mesh->Lods[LodIdx - 1].Error + Error;
+        NumLodIndices += NumDestination;
+        Source = Destination;
+        NumSource = NumDestination;
+    }
+
+    if(!NumLodIndices) {
+        free(LodIndices);
+        return LOAD_SUCCESS;
+    }
+
+    // NOTE(Jovan): Scratch is sized for the worst case, only the levels actually kept move to the arena
+    mesh->LodIndices = (unsigned*)ArenaAlloc(staging, NumLodIndices * sizeof(unsigned));
+    if(!mesh->LodIndices) {
+        free(LodIndices);
+        mesh->NumLods = 1;
+        return LOAD_FAIL;
+    }
+    memcpy(mesh->LodIndices, LodIndices, NumLodIndices * sizeof(unsigned));
+    mesh->NumLodIndices = NumLodIndices;
+    free(LodIndices);
+    return LOAD_SUCCESS;
+}
+
+typedef struct FinishContext {
+    ModelData* Data;
+    volatile long Failed;
+} FinishContext;
+
+static void
+FinishMeshJob(void* data, unsigned meshIdx) {
+    FinishContext* Context = (FinishContext*)data;
+    MeshData* Mesh = &Context->Data->Meshes[meshIdx];
+    uint64_t Start = ProfileStart();
+    if(!BuildMeshlets(Mesh, &Context->Data->Staging) || !BuildMeshLods(Mesh, &Context->Data->Staging)) {
+        AtomicIncrement(&Context->Failed);
+    }
+    Mesh->ProcessSeconds += ProfileElapsed(Start);
+}
+
+static void
+ProcessMesh(void* data, unsigned meshIdx) {
+    ProcessContext* Context = (ProcessContext*)data;
+    MeshData* Mesh = &Context->Data->Meshes[meshIdx];
+    MeshStats* Stats = &Context->Stats[meshIdx];
+    uint64_t Start = ProfileStart();
+
+    Stats->VerticesBefore = Mesh->NumVertices;
+    if(!WeldMeshVertices(Mesh, WELD_EPSILON)) {
+        Stats->Failed = 1;
+        return;
+    }
+    Stats->VerticesAfter = Mesh->NumVertices;
+    // NOTE(Jovan): Welded first, so vertices split only by position duplicates share one smooth normal
+    if(!ComputeTangentSpace(Mesh)) {
+        Stats->Failed = 1;
+        return;
+    }
+
+    AnalyzeVertexCache(Mesh->Indices, Mesh->NumIndices, Mesh->NumVertices, ANALYZE_CACHE_SIZE,
+                       &Stats->AcmrBefore, &Stats->AtvrBefore);
+    if(!OptimizeVertexCache(Mesh)
+       || (OPTIMIZE_OVERDRAW && !OptimizeOverdraw(Mesh))
+       || !OptimizeVertexFetch(Mesh)) {
+        Stats->Failed = 1;
+        return;
+    }
+    AnalyzeVertexCache(Mesh->Indices, Mesh->NumIndices, Mesh->NumVertices, ANALYZE_CACHE_SIZE,
+                       &Stats->AcmrAfter, &Stats->AtvrAfter);
+    Mesh->Acmr = Stats->AcmrAfter;
+    Mesh->Atvr = Stats->AtvrAfter;
+    Mesh->ProcessSeconds = ProfileElapsed(Start);
+}
+
+static int
+CompareSortKeys(const void* a, const void* b) {
+    uint64_t KeyA = *(const uint64_t*)a;
+    uint64_t KeyB = *(const uint64_t*)b;
+    return KeyA < KeyB ? -1 : (KeyA > KeyB ? 1 : 0);
+}
+
+int
+SortMeshesByMaterial(ModelData* data) {
+    if(data->NumMeshes < 2) {
+        return LOAD_SUCCESS;
+    }
+
+    uint64_t* Keys = (uint64_t*)malloc(data->NumMeshes * sizeof(uint64_t));
+    MeshData* Meshes = (MeshData*)malloc(data->NumMeshes * sizeof(MeshData));
+    if(!Keys || !Meshes) {
+        fprintf(stderr, "Failed to allocate mesh sort tables.\n");
+        free(Keys);
+        free(Meshes);
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Mesh index in the low bits keeps import order within a material
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        Keys[MeshIdx] = (uint64_t)data->Meshes[MeshIdx].Material << 32 | MeshIdx;
+    }
+    qsort(Keys, data->NumMeshes, sizeof(uint64_t), CompareSortKeys);
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        Meshes[MeshIdx] = data->Meshes[(uint32_t)Keys[MeshIdx]];
+    }
+
+    memcpy(data->Meshes, Meshes, data->NumMeshes * sizeof(MeshData));
+    free(Keys);
+    free(Meshes);
+    return LOAD_SUCCESS;
+}
+
+int
+ProcessModelData(ModelData* data) {
+    ProcessContext Context;
+    Context.Data = data;
+    Context.Stats = (MeshStats*)calloc(data->NumMeshes ? data->NumMeshes : 1, sizeof(MeshStats));
+    if(!Context.Stats) {
+        fprintf(stderr, "Failed to allocate mesh statistics.\n");
+        return LOAD_FAIL;
+    }
+
+    JobParallelFor(data->NumMeshes, ProcessMesh, &Context);
+
+    int Result = LOAD_SUCCESS;
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshStats* Stats = &Context.Stats[MeshIdx];
+        if(Stats->Failed) {
+            fprintf(stderr, "Failed to process mesh %u.\n", MeshIdx);
+            Result = LOAD_FAIL;
+            continue;
+        }
+        fprintf(stdout, "Mesh %u: welded %u -> %u vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.\n",
+                MeshIdx, Stats->VerticesBefore, Stats->VerticesAfter,
+                Stats->AcmrBefore, Stats->AcmrAfter, Stats->AtvrBefore, Stats->AtvrAfter);
+    }
+
+    free(Context.Stats);
+    // NOTE(Jovan): Split parts inherit the material of their source, sorting comes after so they are ordered too
+    if(!Result || !SplitLargeMeshes(data) || !SortMeshesByMaterial(data)) {
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Meshlets and levels of detail index into final meshes, so they are built after splitting
+    FinishContext Finish;
+    Finish.Data = data;
+    Finish.Failed = 0;
+    JobParallelFor(data->NumMeshes, FinishMeshJob, &Finish);
+    if(Finish.Failed) {
+        fprintf(stderr, "Failed to build meshlets and levels of detail.\n");
+        return LOAD_FAIL;
+    }
+
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        const MeshData* CurrMesh = &data->Meshes[MeshIdx];
+        if(CurrMesh->NumLods < 2) {
+            continue;
+        }
+        fprintf(stdout, "Mesh %u: %u levels of detail,", MeshIdx, CurrMesh->NumLods);
+        for(unsigned LodIdx = 0; LodIdx < CurrMesh->NumLods; ++LodIdx) {
+            fprintf(stdout, " %u", CurrMesh->Lods[LodIdx].NumIndices / 3);
+        }
+        fprintf(stdout, " triangles, error %g.\n", CurrMesh->Lods[CurrMesh->NumLods - 1].Error);
+    }
+    return LOAD_SUCCESS;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file meshprocess.h
+ * @author Jovan Ivosevic
+ * @brief Import-time processing of CPU side mesh data
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef MESHPROCESS_H
+#define MESHPROCESS_H
+
+#include "model.h"
+
+// NOTE(Jovan): 0 welds only bit-identical vertices, positive values snap attributes to a grid of this size
+#define WELD_EPSILON 0.0f
+
+// NOTE(Jovan): Cache size used by the Forsyth scoring, post-transform caches of current GPUs are in this range
+#define FORSYTH_CACHE_SIZE 32
+// NOTE(Jovan): FIFO size used for ACMR/ATVR reporting and overdraw cluster detection
+#define ANALYZE_CACHE_SIZE 16
+#define OPTIMIZE_OVERDRAW 1
+// NOTE(Jovan): Overdraw ordering is dropped if it costs more than this factor in ACMR
+#define OVERDRAW_ACMR_THRESHOLD 1.05f
+// NOTE(Jovan): Meshlet is closed early once a triangle normal is further than this cosine from its average normal
+#define MESHLET_CONE_SPLIT 0.3f
+// NOTE(Jovan): Level of detail is dropped once simplification stalls above this fraction of the previous level
+#define LOD_MIN_REDUCTION 0.8f
+
+/**
+ * @brief Merges duplicate vertices and remaps indices. Every vertex attribute takes part in
+ *        the comparison. With positive epsilon, attributes are compared after snapping to
+ *        a grid of epsilon sized cells, so values straddling a cell boundary are kept apart.
+ *        Meshes without indices are left untouched.
+ *
+ * @param mesh Mesh to be welded
+ * @param epsilon Attribute tolerance, 0 for bit-identical matching
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int WeldMeshVertices(MeshData* mesh, float epsilon);
+
+/**
+ * @brief Simulates FIFO post-transform cache over triangle list
+ *
+ * @param indices Triangle list indices
+ * @param numIndices Number of indices
+ * @param numVertices Number of vertices referenced by indices
+ * @param cacheSize FIFO cache size
+ * @param acmr Output average cache miss ratio, transformed vertices per triangle
+ * @param atvr Output average transform to vertex ratio, transformed vertices per vertex
+ */
+void AnalyzeVertexCache(const unsigned* indices, unsigned numIndices, unsigned numVertices,
+                        unsigned cacheSize, float* acmr, float* atvr);
+
+/**
+ * @brief Reorders triangles for post-transform cache hits using Forsyth's linear-speed algorithm
+ *
+ * @param mesh Mesh to be optimized
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int OptimizeVertexCache(MeshData* mesh);
+
+/**
+ * @brief Splits cache-ordered triangles into clusters at cache flush points and sorts clusters
+ *        so that outward facing ones are drawn first, which helps early depth rejection.
+ *        Order is kept if ACMR degrades by more than OVERDRAW_ACMR_THRESHOLD.
+ *
+ * @param mesh Mesh already optimized for vertex cache
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int OptimizeOverdraw(MeshData* mesh);
+
+/**
+ * @brief Reorders vertices in order of first use by the index buffer
+ *
+ * @param mesh Mesh to be optimized
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int OptimizeVertexFetch(MeshData* mesh);
+
+/**
+ * @brief Splits indexed meshes with more than MAX_INDEX16_VERTICES vertices into consecutive
+ *        triangle ranges that each fit 16-bit indices. Parts replace their source mesh in place.
+ *
+ * @param data Model data, mesh array may be reallocated
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SplitLargeMeshes(ModelData* data);
+
+/**
+ * @brief Stable sort of model meshes by material index, so meshes sharing a material are drawn by one call
+ *
+ * @param data Model data
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SortMeshesByMaterial(ModelData* data);
+
+/**
+ * @brief Partitions mesh triangles into runs of at most MESHLET_MAX_VERTICES vertices and
+ *        MESHLET_MAX_TRIANGLES triangles and computes their bounds and normal cones
+ *
+ * @param mesh Mesh to be partitioned, in final triangle order
+ * @param staging Arena of the model data, receives the meshlet array
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int BuildMeshlets(MeshData* mesh, Arena* staging);
+
+/**
+ * @brief Builds simplified levels of detail at 50%, 25% and 10% of the full triangle count.
+ *        Each level is simplified from the previous one and shares the mesh vertices.
+ *        Levels are vertex cache optimized, their errors accumulate over the chain.
+ *
+ * @param mesh Mesh in final vertex order
+ * @param staging Arena of the model data, receives the level of detail indices
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int BuildMeshLods(MeshData* mesh, Arena* staging);
+
+/**
+ * @brief Runs all import stages on every mesh of the model in parallel and reports per mesh statistics
+ *
+ * @param data Imported model data
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ProcessModelData(ModelData* data);
+
+#endif
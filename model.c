@@ -1,129 +1,679 @@
 #include "model.h"
+#include "objloader.h"
+#include "meshcache.h"
+#include "meshprocess.h"
+#include "platform.h"
+#include "assimpio.h"
+#include "vfs.h"
+#include "hash.h"
+#include "shader.h"
+#include "glstate.h"
 
-int
-LoadModel(const char* filePath, Model* model) {
-    const struct aiScene* Scene = aiImportFile(filePath, POSTPROCESS_FLAGS);
+#include <stddef.h>
+#include <string.h>
+
+static int
+ImportAssimpModelData(const char* filePath, ModelData* data, ModelSources* sources) {
+    // NOTE(Jovan): Assimp reads straight from the asset pack or file mappings instead of its buffered stdio streams
+    struct aiFileIO FileIO;
+    InitAssimpFileIO(&FileIO, sources);
+    const struct aiScene* Scene = aiImportFileEx(filePath, POSTPROCESS_FLAGS, &FileIO);
     if(!Scene) {
         fprintf(stderr, "Failed to load Assimp scene: %s\n", aiGetErrorString());
         return LOAD_FAIL;
     }
 
-    // NOTE(Jovan): Allocate all mesh buffers
-    model->NumMeshes = Scene->mNumMeshes;
-    model->MeshBuffers = (MeshBuffer*)calloc(model->NumMeshes, sizeof(MeshBuffer));
-    if(!model->MeshBuffers) {
-        fprintf(stderr, "Failed to allocate mesh buffer memory.\n");
+    uint64_t TotalVertices = 0, TotalIndices = 0;
+    for(unsigned MeshIdx = 0; MeshIdx < Scene->mNumMeshes; ++MeshIdx) {
+        TotalVertices += Scene->mMeshes[MeshIdx]->mNumVertices;
+        TotalIndices += 3 * (uint64_t)Scene->mMeshes[MeshIdx]->mNumFaces;
+    }
+
+    if(!AllocModelData(data, Scene->mNumMeshes, TotalVertices, TotalIndices)) {
+        aiReleaseImport(Scene);
         return LOAD_FAIL;
     }
 
-    unsigned ElementsPerVertex = 6;
-    // NOTE(Jovan): Attempt to load vertex information into buffers
-    for(unsigned MeshIdx = 0; MeshIdx < model->NumMeshes; ++MeshIdx) {
-        MeshBuffer* CurrMeshBuffer = &model->MeshBuffers[MeshIdx];
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        MeshData* CurrMeshData = &data->Meshes[MeshIdx];
         const struct aiMesh* CurrMesh = Scene->mMeshes[MeshIdx];
         unsigned NumVertices = CurrMesh->mNumVertices;
-        float* Vertices = (float*)calloc(ElementsPerVertex * NumVertices, sizeof(float));
-
-        if(!Vertices) {
+        unsigned NumFaces = CurrMesh->mNumFaces;
+        CurrMeshData->Vertices = (Vertex*)ArenaAlloc(&data->Staging, NumVertices * sizeof(Vertex));
+        CurrMeshData->Indices = (unsigned*)ArenaAlloc(&data->Staging, 3 * NumFaces * sizeof(unsigned));
+        if(!CurrMeshData->Vertices || !CurrMeshData->Indices) {
             fprintf(stderr, "Failed to allocate vertices.\n");
+            FreeModelData(data);
+            aiReleaseImport(Scene);
             return LOAD_FAIL;
         }
 
-        const struct aiMaterial* Material = Scene->mMaterials[Scene->mMeshes[MeshIdx]->mMaterialIndex];
-        const struct aiColor4D Color = { 0.6f, 0.6f, 0.6f, 1.0f };
-        aiGetMaterialColor(Material, AI_MATKEY_COLOR_DIFFUSE, &Color);
+        // NOTE(Jovan): Assimp materials may repeat parameters under different names, the table keeps one of each
+        struct aiColor4D Color = { 0.6f, 0.6f, 0.6f, 1.0f };
+        aiGetMaterialColor(Scene->mMaterials[CurrMesh->mMaterialIndex], AI_MATKEY_COLOR_DIFFUSE, &Color);
+        Material CurrMaterial = { { Color.r, Color.g, Color.b, 1.0f } };
+        if(!AddModelMaterial(data, &CurrMaterial, &CurrMeshData->Material)) {
+            FreeModelData(data);
+            aiReleaseImport(Scene);
+            return LOAD_FAIL;
+        }
+        // NOTE(Jovan): Arena memory isn't cleared, whole vertices are written so normal and tangent start zeroed
         for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
-            Vertices[ElementsPerVertex * VertIdx] = CurrMesh->mVertices[VertIdx].x;
-            Vertices[ElementsPerVertex * VertIdx + 1] = CurrMesh->mVertices[VertIdx].y;
-            Vertices[ElementsPerVertex * VertIdx + 2] = CurrMesh->mVertices[VertIdx].z;
-            Vertices[ElementsPerVertex * VertIdx + 3] = Color.r;
-            Vertices[ElementsPerVertex * VertIdx + 4] = Color.g;
-            Vertices[ElementsPerVertex * VertIdx + 5] = Color.b;
+            Vertex CurrVertex = { 0 };
+            CurrVertex.Position[0] = CurrMesh->mVertices[VertIdx].x;
+            CurrVertex.Position[1] = CurrMesh->mVertices[VertIdx].y;
+            CurrVertex.Position[2] = CurrMesh->mVertices[VertIdx].z;
+            CurrMeshData->Vertices[VertIdx] = CurrVertex;
         }
 
-        unsigned NumFaces = CurrMesh->mNumFaces;
-        if(!NumFaces) continue;
+        for(unsigned FaceIdx = 0; FaceIdx < NumFaces; ++FaceIdx) {
+            const struct aiFace* CurrFace = &CurrMesh->mFaces[FaceIdx];
+            CurrMeshData->Indices[3 * FaceIdx] = CurrFace->mIndices[0];
+            CurrMeshData->Indices[3 * FaceIdx + 1] = CurrFace->mIndices[1];
+            CurrMeshData->Indices[3 * FaceIdx + 2] = CurrFace->mIndices[2];
+        }
 
-        unsigned* Indices = (unsigned*)calloc(3 * NumFaces, sizeof(unsigned));
-        if(!Indices) {
-            fprintf(stderr, "Failed to allocate indices.\n");
-            return LOAD_FAIL;
+        CurrMeshData->NumVertices = NumVertices;
+        CurrMeshData->NumIndices = 3 * NumFaces;
+    }
+
+    aiReleaseImport(Scene);
+    return LOAD_SUCCESS;
+}
+
+int
+InitModelMeshes(const BakedModel* baked, Model* model) {
+    memset(model, 0, sizeof(Model));
+    unsigned NumMeshes = baked->Header->NumMeshes;
+    model->MeshBuffers = (MeshBuffer*)calloc(NumMeshes ? NumMeshes : 1, sizeof(MeshBuffer));
+    model->DrawCounts = (GLsizei*)malloc((NumMeshes ? NumMeshes : 1) * sizeof(GLsizei));
+    model->DrawOffsets = (const void**)malloc((NumMeshes ? NumMeshes : 1) * sizeof(void*));
+    model->DrawBaseVertices = (GLint*)malloc((NumMeshes ? NumMeshes : 1) * sizeof(GLint));
+    size_t NumMeshlets = (size_t)baked->Header->NumMeshlets;
+    model->Meshlets = (Meshlet*)malloc((NumMeshlets ? NumMeshlets : 1) * sizeof(Meshlet));
+    model->CullCounts = (GLsizei*)malloc((NumMeshlets ? NumMeshlets : 1) * sizeof(GLsizei));
+    model->CullOffsets = (const void**)malloc((NumMeshlets ? NumMeshlets : 1) * sizeof(void*));
+    model->CullBaseVertices = (GLint*)malloc((NumMeshlets ? NumMeshlets : 1) * sizeof(GLint));
+    if(!model->MeshBuffers || !model->DrawCounts || !model->DrawOffsets || !model->DrawBaseVertices
+       || !model->Meshlets || !model->CullCounts || !model->CullOffsets || !model->CullBaseVertices) {
+        fprintf(stderr, "Failed to allocate mesh buffer memory.\n");
+        FreeModelResources(model);
+        return LOAD_FAIL;
+    }
+    if(NumMeshlets) {
+        memcpy(model->Meshlets, baked->Meshlets, NumMeshlets * sizeof(Meshlet));
+    }
+    model->NumMeshlets = (unsigned)NumMeshlets;
+    model->NumMaterials = baked->Header->NumMaterials;
+
+    model->NumMeshes = NumMeshes;
+    model->VertexFormat = baked->Header->VertexFormat;
+    memcpy(model->PosScale, baked->Header->PosScale, sizeof(model->PosScale));
+    memcpy(model->PosOffset, baked->Header->PosOffset, sizeof(model->PosOffset));
+    model->Sources = baked->Header->Sources;
+    for(unsigned MeshIdx = 0; MeshIdx < NumMeshes; ++MeshIdx) {
+        const MeshRange* CurrRange = &baked->Meshes[MeshIdx];
+        MeshBuffer* CurrBuffer = &model->MeshBuffers[MeshIdx];
+        CurrBuffer->FirstVertex = CurrRange->FirstVertex;
+        CurrBuffer->VerticesCount = CurrRange->NumVertices;
+        CurrBuffer->IndexOffset = CurrRange->IndexOffset;
+        CurrBuffer->IndicesCount = CurrRange->NumIndices;
+        CurrBuffer->IndexType = CurrRange->IndexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        CurrBuffer->FirstMeshlet = CurrRange->FirstMeshlet;
+        CurrBuffer->NumMeshlets = CurrRange->NumMeshlets;
+        CurrBuffer->NumLods = CurrRange->NumLods;
+        memcpy(CurrBuffer->Lods, CurrRange->Lods, sizeof(CurrBuffer->Lods));
+        CurrBuffer->Material = CurrRange->Material;
+        memcpy(CurrBuffer->BoundsMin, CurrRange->BoundsMin, sizeof(CurrBuffer->BoundsMin));
+        memcpy(CurrBuffer->BoundsMax, CurrRange->BoundsMax, sizeof(CurrBuffer->BoundsMax));
+        CurrBuffer->Acmr = CurrRange->Acmr;
+        CurrBuffer->Atvr = CurrRange->Atvr;
+        model->DrawCounts[MeshIdx] = CurrBuffer->NumLods ? (GLsizei)CurrBuffer->Lods[0].NumIndices : 0;
+        model->DrawOffsets[MeshIdx] = (const void*)(uintptr_t)CurrBuffer->IndexOffset;
+        model->DrawBaseVertices[MeshIdx] = (GLint)CurrBuffer->FirstVertex;
+    }
+
+    return LOAD_SUCCESS;
+}
+
+void
+CreateModelBuffers(const BakedModel* baked, Model* model, LoadProfile* profile) {
+    uint64_t Start = ProfileStart();
+    // NOTE(Jovan): Copy target keeps this independent of VAO state, so it also works on the upload context
+    glGenBuffers(1, &model->VBO);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, model->VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)baked->Header->VertexBytes, NULL, GL_STATIC_DRAW);
+    if(baked->Header->IndexBytes) {
+        glGenBuffers(1, &model->EBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, model->EBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)baked->Header->IndexBytes, NULL, GL_STATIC_DRAW);
+    }
+    // NOTE(Jovan): Block is declared with MAX_MATERIALS entries, binding a smaller buffer is undefined
+    if(baked->Header->NumMaterials) {
+        glGenBuffers(1, &model->MaterialUBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, model->MaterialUBO);
+        glBufferData(GL_COPY_WRITE_BUFFER, MAX_MATERIALS * sizeof(Material), NULL, GL_STATIC_DRAW);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, baked->Header->NumMaterials * sizeof(Material), baked->Materials);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    ProfileAddStage(profile, PROFILE_STAGE_UPLOAD, ProfileElapsed(Start), baked->Header->NumMaterials * sizeof(Material));
+}
+
+int
+SetModelMaterial(const Model* model, unsigned materialIdx, const Material* material) {
+    if(materialIdx >= model->NumMaterials) {
+        fprintf(stderr, "Material %u out of range.\n", materialIdx);
+        return LOAD_FAIL;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, model->MaterialUBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, materialIdx * sizeof(Material), sizeof(Material), material);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return LOAD_SUCCESS;
+}
+
+void
+UploadMeshBuffers(const BakedModel* baked, unsigned meshIdx, const Model* model, LoadProfile* profile) {
+    uint64_t Start = ProfileStart();
+    const MeshRange* CurrRange = &baked->Meshes[meshIdx];
+    size_t Stride = baked->Header->VertexStride;
+    if(CurrRange->NumVertices) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, model->VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(CurrRange->FirstVertex * Stride), (GLsizeiptr)(CurrRange->NumVertices * Stride),
+                        baked->Vertices + CurrRange->FirstVertex * Stride);
+    }
+    if(CurrRange->NumIndices) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, model->EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)CurrRange->IndexOffset, (GLsizeiptr)CurrRange->NumIndices * CurrRange->IndexSize,
+                        baked->Indices + CurrRange->IndexOffset);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    double Seconds = ProfileElapsed(Start);
+    uint64_t Bytes = (uint64_t)CurrRange->NumVertices * Stride + (uint64_t)CurrRange->NumIndices * CurrRange->IndexSize;
+    ProfileAddMeshStage(profile, meshIdx, PROFILE_STAGE_UPLOAD, Seconds, Bytes);
+    ProfileAddStage(profile, PROFILE_STAGE_UPLOAD, Seconds, Bytes);
+}
+
+void
+CreateModelVertexArray(Model* model) {
+    glGenVertexArrays(1, &model->VAO);
+    StateBindVertexArray(model->VAO);
+    StateBindBuffer(GL_ARRAY_BUFFER, model->VBO);
+    GLsizei Stride = (GLsizei)VertexFormatStride(model->VertexFormat);
+    // NOTE(Jovan): Both compact formats are read as [-1, 1] and expanded with uPosScale and uPosOffset.
+    // Color attribute stays disabled, shader takes color from the material table.
+    if(model->VertexFormat == VERTEX_FORMAT_FLOAT) {
+        glVertexAttribPointer(LAYOUT_POSITION, 3, GL_FLOAT, GL_FALSE, Stride, (void*)offsetof(Vertex, Position));
+    } else if(model->VertexFormat == VERTEX_FORMAT_HALF) {
+        glVertexAttribPointer(LAYOUT_POSITION, 3, GL_HALF_FLOAT, GL_FALSE, Stride, (void*)offsetof(PackedVertex, Position));
+    } else {
+        glVertexAttribPointer(LAYOUT_POSITION, 3, GL_SHORT, GL_TRUE, Stride, (void*)offsetof(PackedVertex, Position));
+    }
+    if(model->VertexFormat == VERTEX_FORMAT_FLOAT) {
+        glVertexAttribPointer(LAYOUT_NORMAL, 3, GL_FLOAT, GL_FALSE, Stride, (void*)offsetof(Vertex, Normal));
+        glVertexAttribPointer(LAYOUT_TANGENT, 4, GL_FLOAT, GL_FALSE, Stride, (void*)offsetof(Vertex, Tangent));
+    } else {
+        glVertexAttribPointer(LAYOUT_NORMAL, 4, GL_INT_2_10_10_10_REV, GL_TRUE, Stride, (void*)offsetof(PackedVertex, Normal));
+        glVertexAttribPointer(LAYOUT_TANGENT, 4, GL_INT_2_10_10_10_REV, GL_TRUE, Stride, (void*)offsetof(PackedVertex, Tangent));
+    }
+    glEnableVertexAttribArray(LAYOUT_POSITION);
+    glEnableVertexAttribArray(LAYOUT_NORMAL);
+    glEnableVertexAttribArray(LAYOUT_TANGENT);
+    // NOTE(Jovan): Element buffer binding is VAO state, drawing needs no further binds
+    StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->EBO);
+    StateBindVertexArray(0);
+}
+
+void
+AttachModelBuffers(const Model* model) {
+    // NOTE(Jovan): Element buffer is attached to the VAO, array buffer is the context binding the attributes were sourced from
+    StateBindVertexArray(model->VAO);
+    StateForceBindBuffer(GL_ARRAY_BUFFER, model->VBO);
+    StateForceBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->EBO);
+}
+
+static uint64_t
+MeshDataBytes(const MeshData* mesh) {
+    return (uint64_t)mesh->NumVertices * sizeof(Vertex)
+         + (uint64_t)(mesh->NumIndices + mesh->NumLodIndices) * sizeof(unsigned)
+         + (uint64_t)mesh->NumMeshlets * sizeof(Meshlet);
+}
+
+static uint64_t
+ModelDataBytes(const ModelData* data) {
+    uint64_t Bytes = (uint64_t)data->NumMaterials * sizeof(Material);
+    for(unsigned MeshIdx = 0; MeshIdx < data->NumMeshes; ++MeshIdx) {
+        Bytes += MeshDataBytes(&data->Meshes[MeshIdx]);
+    }
+    return Bytes;
+}
+
+int
+ImportBakedModel(const char* filePath, BakedModel* baked, LoadProfile* profile) {
+    uint64_t Start = ProfileStart();
+    if(LoadMeshCache(filePath, baked)) {
+        ProfileAddStage(profile, PROFILE_STAGE_FILE_READ, ProfileElapsed(Start), baked->File.Size);
+        ProfileSetMeshCount(profile, baked->Header->NumMeshes);
+        if(profile) {
+            profile->FromCache = 1;
         }
+        return LOAD_SUCCESS;
+    }
+    ProfileAddStage(profile, PROFILE_STAGE_FILE_READ, ProfileElapsed(Start), 0);
 
-        for(unsigned FaceIdx = 0; FaceIdx < NumFaces; ++FaceIdx) {
-            const struct aiFace* CurrFace = &CurrMesh->mFaces[FaceIdx];
-            Indices[3 * FaceIdx] = CurrFace->mIndices[0];
-            Indices[3 * FaceIdx + 1] = CurrFace->mIndices[1];
-            Indices[3 * FaceIdx + 2] = CurrFace->mIndices[2];
+    Start = ProfileStart();
+    ModelData Data = { 0 };
+    ModelSources Sources = { 0 };
+    int Imported = LOAD_FAIL;
+    // NOTE(Jovan): Native importer handles OBJ, Assimp covers everything else and malformed OBJ files
+    if(IsObjFile(filePath)) {
+        Imported = LoadObjModelData(filePath, &Data, &Sources);
+        if(!Imported) {
+            fprintf(stderr, "Native OBJ import failed, falling back to Assimp.\n");
         }
+    }
 
-        CurrMeshBuffer->VerticesCount = NumVertices;
-        CurrMeshBuffer->IndicesCount = 3 * NumFaces;
+    if(!Imported) {
+        memset(&Sources, 0, sizeof(Sources));
+        Imported = ImportAssimpModelData(filePath, &Data, &Sources);
+    }
 
-        glGenVertexArrays(1, &CurrMeshBuffer->VAO);
-        glBindVertexArray(CurrMeshBuffer->VAO);
-        glGenBuffers(1, &CurrMeshBuffer->VBO);
-        glBindBuffer(GL_ARRAY_BUFFER, CurrMeshBuffer->VBO);
-        glBufferData(GL_ARRAY_BUFFER, NumVertices * ElementsPerVertex * sizeof(float), Vertices, GL_STATIC_DRAW);
-        glVertexAttribPointer(LAYOUT_POSITION, 3, GL_FLOAT, GL_FALSE, ElementsPerVertex * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(LAYOUT_POSITION);
-        glVertexAttribPointer(LAYOUT_COLOR, 3, GL_FLOAT, GL_FALSE, ElementsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(LAYOUT_COLOR);
-        if(CurrMeshBuffer->IndicesCount) {
-            glGenBuffers(1, &CurrMeshBuffer->EBO);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, CurrMeshBuffer->EBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, CurrMeshBuffer->IndicesCount * sizeof(unsigned), Indices, GL_STATIC_DRAW);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    if(!Imported) {
+        return LOAD_FAIL;
+    }
+
+    uint64_t SourceBytes = 0;
+    for(unsigned SourceIdx = 0; SourceIdx < Sources.NumSources; ++SourceIdx) {
+        SourceBytes += Sources.Sources[SourceIdx].Size;
+    }
+    ProfileAddStage(profile, PROFILE_STAGE_IMPORT, ProfileElapsed(Start), SourceBytes);
+
+    Start = ProfileStart();
+    int Result = ProcessModelData(&Data);
+    ProfileAddStage(profile, PROFILE_STAGE_PROCESS, ProfileElapsed(Start), ModelDataBytes(&Data));
+    if(Result) {
+        // NOTE(Jovan): Meshes are final after processing, baking keeps their order
+        ProfileSetMeshCount(profile, Data.NumMeshes);
+        for(unsigned MeshIdx = 0; MeshIdx < Data.NumMeshes; ++MeshIdx) {
+            const MeshData* CurrMesh = &Data.Meshes[MeshIdx];
+            ProfileAddMeshStage(profile, MeshIdx, PROFILE_STAGE_PROCESS, CurrMesh->ProcessSeconds, MeshDataBytes(CurrMesh));
         }
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindVertexArray(0);
-        if(NumVertices) {
-            free(Vertices);
+        Result = BakeModelData(&Data, baked, profile);
+    }
+
+    Start = ProfileStart();
+    uint64_t StagingBytes = Data.Staging.Used;
+    FreeModelData(&Data);
+    ProfileAddStage(profile, PROFILE_STAGE_TEARDOWN, ProfileElapsed(Start), StagingBytes);
+
+    Start = ProfileStart();
+    if(Result && !WriteMeshCache(filePath, baked, &Sources)) {
+        fprintf(stderr, "Mesh cache for %s not written, next start will import again.\n", filePath);
+    }
+    ProfileAddStage(profile, PROFILE_STAGE_CACHE_WRITE, ProfileElapsed(Start), Result ? baked->Header->FileSize : 0);
+    return Result;
+}
+
+int
+LoadModel(const char* filePath, Model* model) {
+    BakedModel Baked;
+    LoadProfile Profile = { 0 };
+    if(!ImportBakedModel(filePath, &Baked, &Profile)) {
+        FreeLoadProfile(&Profile);
+        return LOAD_FAIL;
+    }
+
+    if(!InitModelMeshes(&Baked, model)) {
+        FreeBakedModel(&Baked);
+        FreeLoadProfile(&Profile);
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Baked sections point straight into the cache image, no per-vertex copies
+    CreateModelBuffers(&Baked, model, &Profile);
+    for(unsigned MeshIdx = 0; MeshIdx < model->NumMeshes; ++MeshIdx) {
+        UploadMeshBuffers(&Baked, MeshIdx, model, &Profile);
+    }
+    uint64_t Start = ProfileStart();
+    CreateModelVertexArray(model);
+    model->NumResident = model->NumMeshes;
+    ProfileAddStage(&Profile, PROFILE_STAGE_UPLOAD, ProfileElapsed(Start), 0);
+
+    fprintf(stdout, "Loaded %d meshes%s in %.1f ms.\n", model->NumMeshes, Baked.File.Data ? " from cache" : "", Profile.TotalSeconds * 1000.0);
+    Start = ProfileStart();
+    uint64_t StagingBytes = Baked.File.Data ? 0 : Baked.Header->FileSize;
+    FreeBakedModel(&Baked);
+    ProfileAddStage(&Profile, PROFILE_STAGE_TEARDOWN, ProfileElapsed(Start), StagingBytes);
+    model->Profile = Profile;
+    return LOAD_SUCCESS;
+}
+
+unsigned
+VertexFormatStride(unsigned format) {
+    switch(format) {
+        case VERTEX_FORMAT_FLOAT: return sizeof(Vertex);
+        case VERTEX_FORMAT_HALF:
+        case VERTEX_FORMAT_SNORM16: return sizeof(PackedVertex);
+    }
+    return 0;
+}
+
+int
+AllocModelData(ModelData* data, unsigned numMeshes, uint64_t numVertices, uint64_t numIndices) {
+    data->NumMeshes = 0;
+    // NOTE(Jovan): Room for levels of detail as large as the full index set and one meshlet per 16 triangles.
+    // Split meshes and odd inputs may still outgrow it, the arena then chains another block.
+    uint64_t Capacity = numVertices * sizeof(Vertex) + 2 * numIndices * sizeof(unsigned)
+                      + (numIndices / 48 + numMeshes) * sizeof(Meshlet)
+                      + (uint64_t)numMeshes * (sizeof(MeshData) + 4 * ARENA_ALIGNMENT)
+                      + MAX_MATERIALS * sizeof(Material);
+    if(!ArenaInit(&data->Staging, (size_t)Capacity)) {
+        return LOAD_FAIL;
+    }
+
+    data->Meshes = (MeshData*)ArenaAlloc(&data->Staging, (numMeshes ? numMeshes : 1) * sizeof(MeshData));
+    if(!data->Meshes) {
+        fprintf(stderr, "Failed to allocate mesh data.\n");
+        ArenaRelease(&data->Staging);
+        return LOAD_FAIL;
+    }
+
+    memset(data->Meshes, 0, (numMeshes ? numMeshes : 1) * sizeof(MeshData));
+    data->NumMeshes = numMeshes;
+    return LOAD_SUCCESS;
+}
+
+int
+AddModelMaterial(ModelData* data, const Material* material, unsigned* materialIdx) {
+    for(unsigned MaterialIdx = 0; MaterialIdx < data->NumMaterials; ++MaterialIdx) {
+        if(!memcmp(&data->Materials[MaterialIdx], material, sizeof(Material))) {
+            *materialIdx = MaterialIdx;
+            return LOAD_SUCCESS;
         }
+    }
 
-        if(NumFaces){
-            free(Indices);
+    if(data->NumMaterials == MAX_MATERIALS) {
+        fprintf(stderr, "Material table full, mesh falls back to the first material.\n");
+        *materialIdx = 0;
+        return LOAD_SUCCESS;
+    }
+
+    if(!data->Materials) {
+        data->Materials = (Material*)ArenaAlloc(&data->Staging, MAX_MATERIALS * sizeof(Material));
+        if(!data->Materials) {
+            fprintf(stderr, "Failed to allocate material table.\n");
+            return LOAD_FAIL;
         }
     }
-    fprintf(stdout, "Loaded %d meshes.\n", model->NumMeshes);
 
-    aiReleaseImport(Scene);
+    data->Materials[data->NumMaterials] = *material;
+    *materialIdx = data->NumMaterials++;
     return LOAD_SUCCESS;
 }
 
+void
+AddModelSource(ModelSources* sources, const char* filePath, const VfsFile* file) {
+    size_t PathLength = strlen(filePath);
+    if(PathLength >= MODEL_SOURCE_MAX_PATH) {
+        sources->Incomplete = 1;
+        return;
+    }
+
+    unsigned SourceIdx = 0;
+    while(SourceIdx < sources->NumSources && strcmp(sources->Sources[SourceIdx].Path, filePath)) {
+        ++SourceIdx;
+    }
+    if(SourceIdx == MAX_MODEL_SOURCES) {
+        sources->Incomplete = 1;
+        return;
+    }
+
+    SourceKey* Key = &sources->Sources[SourceIdx];
+    memcpy(Key->Path, filePath, PathLength + 1);
+    Key->Size = file->Size;
+    Key->ModifiedTime = file->ModifiedTime;
+    Key->Hash = HashBytes(file->Data, file->Size, 0);
+    if(SourceIdx == sources->NumSources) {
+        ++sources->NumSources;
+    }
+}
+
+void
+FreeModelData(ModelData* data) {
+    ArenaRelease(&data->Staging);
+    data->Meshes = NULL;
+    data->NumMeshes = 0;
+    data->Materials = NULL;
+    data->NumMaterials = 0;
+}
+
 void
 FreeModelResources(Model* model) {
     fprintf(stdout, "Freeing model\n");
-    for(unsigned MeshIdx = 0; MeshIdx < model->NumMeshes; ++MeshIdx) {
-        MeshBuffer* CurrMesh = &model->MeshBuffers[MeshIdx];
-        fprintf(stdout, "Freeing VBO\n");
-        if(CurrMesh->VerticesCount) {
-            glDeleteBuffers(1, &CurrMesh->VBO);
-        }
-        fprintf(stdout, "Freeing EBO\n");
-        if(CurrMesh->IndicesCount) {
-            glDeleteBuffers(1, &CurrMesh->EBO);
-        }
-        fprintf(stdout, "Freeing VAO\n");
-        glDeleteVertexArrays(1, &CurrMesh->VAO);
+    fprintf(stdout, "Freeing VBO\n");
+    if(model->VBO) {
+        StateDeleteBuffers(1, &model->VBO);
+    }
+    fprintf(stdout, "Freeing EBO\n");
+    if(model->EBO) {
+        StateDeleteBuffers(1, &model->EBO);
+    }
+    if(model->MaterialUBO) {
+        StateDeleteBuffers(1, &model->MaterialUBO);
+    }
+    fprintf(stdout, "Freeing VAO\n");
+    if(model->VAO) {
+        StateDeleteVertexArrays(1, &model->VAO);
     }
     fprintf(stdout, "Freeing meshes\n");
     free(model->MeshBuffers);
+    free(model->DrawCounts);
+    free(model->DrawOffsets);
+    free(model->DrawBaseVertices);
+    free(model->Meshlets);
+    free(model->CullCounts);
+    free(model->CullOffsets);
+    free(model->CullBaseVertices);
+    FreeLoadProfile(&model->Profile);
+    memset(model, 0, sizeof(Model));
+}
+
+typedef struct ModelUniforms {
+    GLint PosScale;
+    GLint PosOffset;
+    GLint Material;
+} ModelUniforms;
+
+static void
+BeginModelDraw(const Model* model, ModelUniforms* uniforms) {
+    // NOTE(Jovan): Locations come from the table reflected at link time, missing uniforms resolve to -1,
+    // which glUniform silently ignores
+    unsigned Program = GetCurrentShaderProgram();
+    uniforms->PosScale = GetUniformLocation(Program, "uPosScale");
+    uniforms->PosOffset = GetUniformLocation(Program, "uPosOffset");
+    uniforms->Material = GetUniformLocation(Program, "uMaterial");
+    glUniform3fv(uniforms->PosScale, 1, model->PosScale);
+    glUniform3fv(uniforms->PosOffset, 1, model->PosOffset);
+
+    // NOTE(Jovan): Materials block of the program was pointed at MATERIAL_BINDING when it was linked
+    if(model->MaterialUBO) {
+        StateBindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BINDING, model->MaterialUBO);
+    }
+    StateBindVertexArray(model->VAO);
+}
+
+static void
+EndModelDraw(const ModelUniforms* uniforms) {
+    // NOTE(Jovan): VAO stays bound, the state cache skips rebinding it for the next draw of this model
+    // NOTE(Jovan): Hand made float VAOs share the program and rely on identity dequantization and vertex colors
+    glUniform3f(uniforms->PosScale, 1.0f, 1.0f, 1.0f);
+    glUniform3f(uniforms->PosOffset, 0.0f, 0.0f, 0.0f);
+    glUniform1i(uniforms->Material, -1);
 }
 
 void
 RenderModel(const Model* model) {
-    for(unsigned MeshIdx = 0; MeshIdx < model->NumMeshes; ++MeshIdx) {
+    if(!model->NumResident) {
+        return;
+    }
+
+    ModelUniforms Uniforms;
+    BeginModelDraw(model, &Uniforms);
+    for(unsigned MeshIdx = 0; MeshIdx < model->NumResident;) {
         const MeshBuffer* CurrBuffer = &model->MeshBuffers[MeshIdx];
-        glBindVertexArray(CurrBuffer->VAO);
-        if(CurrBuffer->IndicesCount) {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, CurrBuffer->EBO);
-            glDrawElements(GL_TRIANGLES, CurrBuffer->IndicesCount, GL_UNSIGNED_INT, (void*)0);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-            glBindVertexArray(0);
+        glUniform1i(Uniforms.Material, (GLint)CurrBuffer->Material);
+        if(!CurrBuffer->IndicesCount) {
+            glDrawArrays(GL_TRIANGLES, (GLint)CurrBuffer->FirstVertex, CurrBuffer->VerticesCount);
+            ++MeshIdx;
             continue;
         }
-        glDrawArrays(GL_TRIANGLES, 0, CurrBuffer->VerticesCount);
-        glBindVertexArray(0);
+
+        // NOTE(Jovan): Meshes are sorted by material on import, so meshes sharing a call are consecutive
+        unsigned RunEnd = MeshIdx + 1;
+        while(RunEnd < model->NumResident && model->MeshBuffers[RunEnd].IndicesCount
+              && model->MeshBuffers[RunEnd].Material == CurrBuffer->Material
+              && model->MeshBuffers[RunEnd].IndexType == CurrBuffer->IndexType) {
+            ++RunEnd;
+        }
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, &model->DrawCounts[MeshIdx], CurrBuffer->IndexType,
+                                      &model->DrawOffsets[MeshIdx], (GLsizei)(RunEnd - MeshIdx),
+                                      &model->DrawBaseVertices[MeshIdx]);
+        MeshIdx = RunEnd;
+    }
+    EndModelDraw(&Uniforms);
+}
+
+/**
+ * @brief Sphere is behind every triangle of the meshlet if camera lies inside the backfacing cone
+ *
+ */
+static int
+IsMeshletBackfacing(const Meshlet* meshlet, vec3 camera) {
+    if(meshlet->ConeCutoff >= 1.0f) {
+        return 0;
     }
-}
\ No newline at end of file
+
+    vec3 Direction;
+    glm_vec3_sub((float*)meshlet->Sphere, camera, Direction);
+    return glm_vec3_dot(Direction, (float*)meshlet->ConeAxis) >= meshlet->ConeCutoff * glm_vec3_norm(Direction) + meshlet->Sphere[3];
+}
+
+/**
+ * @brief Picks the coarsest level whose error projected at the nearest point of the mesh bounding
+ *        sphere stays under LOD_PIXEL_ERROR. Levels coarser than the current one need extra headroom.
+ *
+ */
+static unsigned
+SelectMeshLod(MeshBuffer* buffer, vec3 camera, float pixelScale) {
+    vec3 Box[2], Center;
+    glm_vec3_copy(buffer->BoundsMin, Box[0]);
+    glm_vec3_copy(buffer->BoundsMax, Box[1]);
+    glm_aabb_center(Box, Center);
+    float Distance = glm_vec3_distance(Center, camera) - glm_aabb_radius(Box);
+    unsigned Lod = 0;
+    // NOTE(Jovan): Camera inside the bounds sees the mesh up close from some side, stay at full detail
+    for(unsigned LodIdx = buffer->NumLods - 1; Distance > 0.0f && pixelScale > 0.0f && LodIdx > 0; --LodIdx) {
+        float Limit = LodIdx > buffer->CurrentLod ? LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS) : LOD_PIXEL_ERROR;
+        if(buffer->Lods[LodIdx].Error * pixelScale <= Limit * Distance) {
+            Lod = LodIdx;
+            break;
+        }
+    }
+
+    buffer->CurrentLod = Lod;
+    return Lod;
+}
+
+static void
+DrawCulledBatch(const Model* model, unsigned firstDraw, unsigned numDraws, GLenum indexType,
+                GLint materialLocation, unsigned material) {
+    glUniform1i(materialLocation, (GLint)material);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, &model->CullCounts[firstDraw], indexType,
+                                  &model->CullOffsets[firstDraw], (GLsizei)numDraws,
+                                  &model->CullBaseVertices[firstDraw]);
+}
+
+unsigned
+RenderModelCulled(Model* model, const RenderView* view, mat4 modelMatrix) {
+    if(!model->NumResident) {
+        return 0;
+    }
+
+    // NOTE(Jovan): Planes of the model-view-projection matrix are frustum planes in model space
+    mat4 ModelViewProjection, InverseModel;
+    vec4 Planes[6];
+    vec3 Camera;
+    glm_mat4_mul((vec4*)view->ViewProjection, modelMatrix, ModelViewProjection);
+    glm_frustum_planes(ModelViewProjection, Planes);
+    glm_mat4_inv(modelMatrix, InverseModel);
+    glm_mat4_mulv3(InverseModel, (float*)view->CameraPosition, 1.0f, Camera);
+
+    ModelUniforms Uniforms;
+    BeginModelDraw(model, &Uniforms);
+
+    unsigned NumDraws = 0, NumVisible = 0;
+    // NOTE(Jovan): Ranges are batched until material or index type changes
+    unsigned BatchStart = 0, BatchMaterial = 0;
+    GLenum BatchType = 0;
+    for(unsigned MeshIdx = 0; MeshIdx < model->NumResident; ++MeshIdx) {
+        MeshBuffer* CurrBuffer = &model->MeshBuffers[MeshIdx];
+        vec3 Box[2];
+        glm_vec3_copy((float*)CurrBuffer->BoundsMin, Box[0]);
+        glm_vec3_copy((float*)CurrBuffer->BoundsMax, Box[1]);
+        if(!glm_aabb_frustum(Box, Planes)) {
+            continue;
+        }
+        if(!CurrBuffer->IndicesCount) {
+            glUniform1i(Uniforms.Material, (GLint)CurrBuffer->Material);
+            glDrawArrays(GL_TRIANGLES, (GLint)CurrBuffer->FirstVertex, CurrBuffer->VerticesCount);
+            continue;
+        }
+
+        if(NumDraws > BatchStart && (CurrBuffer->Material != BatchMaterial || CurrBuffer->IndexType != BatchType)) {
+            DrawCulledBatch(model, BatchStart, NumDraws - BatchStart, BatchType, Uniforms.Material, BatchMaterial);
+            BatchStart = NumDraws;
+        }
+        BatchMaterial = CurrBuffer->Material;
+        BatchType = CurrBuffer->IndexType;
+
+        unsigned IndexSize = CurrBuffer->IndexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+        unsigned MeshDraws = NumDraws;
+        uintptr_t DrawEnd = 0;
+        unsigned Lod = SelectMeshLod(CurrBuffer, Camera, view->PixelScale);
+        if(Lod) {
+            // NOTE(Jovan): Every indexed mesh has at least one meshlet, so this fits the scratch arrays
+            const MeshLod* CurrLod = &CurrBuffer->Lods[Lod];
+            model->CullCounts[NumDraws] = (GLsizei)CurrLod->NumIndices;
+            model->CullOffsets[NumDraws] = (const void*)(CurrBuffer->IndexOffset + (uintptr_t)CurrLod->FirstIndex * IndexSize);
+            model->CullBaseVertices[NumDraws] = (GLint)CurrBuffer->FirstVertex;
+            ++NumDraws;
+        }
+        for(unsigned MeshletIdx = 0; !Lod && MeshletIdx < CurrBuffer->NumMeshlets; ++MeshletIdx) {
+            const Meshlet* CurrMeshlet = &model->Meshlets[CurrBuffer->FirstMeshlet + MeshletIdx];
+            glm_vec3_copy((float*)CurrMeshlet->BoundsMin, Box[0]);
+            glm_vec3_copy((float*)CurrMeshlet->BoundsMax, Box[1]);
+            if(!glm_aabb_frustum(Box, Planes) || IsMeshletBackfacing(CurrMeshlet, Camera)) {
+                continue;
+            }
+
+            ++NumVisible;
+            uintptr_t Offset = CurrBuffer->IndexOffset + (uintptr_t)CurrMeshlet->FirstIndex * IndexSize;
+            if(NumDraws > MeshDraws && DrawEnd == Offset) {
+                model->CullCounts[NumDraws - 1] += (GLsizei)CurrMeshlet->NumIndices;
+            } else {
+                model->CullCounts[NumDraws] = (GLsizei)CurrMeshlet->NumIndices;
+                model->CullOffsets[NumDraws] = (const void*)Offset;
+                model->CullBaseVertices[NumDraws] = (GLint)CurrBuffer->FirstVertex;
+                ++NumDraws;
+            }
+            DrawEnd = Offset + (uintptr_t)CurrMeshlet->NumIndices * IndexSize;
+        }
+    }
+
+    if(NumDraws > BatchStart) {
+        DrawCulledBatch(model, BatchStart, NumDraws - BatchStart, BatchType, Uniforms.Material, BatchMaterial);
+    }
+    EndModelDraw(&Uniforms);
+    return NumVisible;
+}
@@ -17,39 +17,230 @@
 #define LOAD_FAIL 0
 #define LAYOUT_POSITION 0
 #define LAYOUT_COLOR 1
+#define LAYOUT_NORMAL 2
+#define LAYOUT_TANGENT 3
+// NOTE(Jovan): Must match the array size of the Materials block in shaders/basic.vert
+#define MAX_MATERIALS 256
+#define MATERIAL_BINDING 0
+// NOTE(Jovan): Meshes up to this many vertices are drawn with 16-bit indices, larger ones are split on import
+#define MAX_INDEX16_VERTICES 65536
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+// NOTE(Jovan): Full detail mesh plus simplified levels, all indexing the same vertices
+#define MESH_MAX_LODS 4
+// NOTE(Jovan): Coarser level is picked once its simplification error covers less than this many pixels on screen
+#define LOD_PIXEL_ERROR 1.0f
+// NOTE(Jovan): Switching to a coarser level needs this much error headroom, which stops flicker at the threshold
+#define LOD_HYSTERESIS 0.25f
+#define VERTEX_FORMAT_FLOAT 0
+#define VERTEX_FORMAT_HALF 1
+#define VERTEX_FORMAT_SNORM16 2
+// NOTE(Jovan): Layout baked into mesh caches, caches baked with a different one are rebuilt on load
+#define VERTEX_FORMAT VERTEX_FORMAT_SNORM16
+// NOTE(Jovan): Model file plus the files it references, e.g. its mtllib
+#define MAX_MODEL_SOURCES 4
+#define MODEL_SOURCE_MAX_PATH 256
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assimp/cimport.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <GL/glew.h>
+#include "cglm/cglm.h"
+#include "loadprofile.h"
+#include "arena.h"
 
 /**
- * @brief Internal buffer representation for each model mesh
+ * @brief Interleaved vertex layout produced by importers and uploaded as is by VERTEX_FORMAT_FLOAT.
+ *        Surface color comes from the mesh material, not from vertices. Importers leave normal and
+ *        tangent zeroed, they are generated during processing. Tangent w holds bitangent handedness.
+ * 
+ */
+typedef struct Vertex {
+    float Position[3];
+    float Normal[3];
+    float Tangent[4];
+} Vertex;
+
+/**
+ * @brief Compact vertex layout of half-float and 16-bit normalized formats. Positions are stored
+ *        relative to model bounds and expanded by the vertex shader with uPosScale and uPosOffset.
+ *        Normal and tangent are signed normalized 2_10_10_10_REV, x in the lowest bits.
+ * 
+ */
+typedef struct PackedVertex {
+    uint16_t Position[3];
+    uint16_t Padding;
+    uint32_t Normal;
+    uint32_t Tangent;
+} PackedVertex;
+
+/**
+ * @brief Surface parameters shared by meshes, laid out as one std140 array element of the Materials block
+ * 
+ */
+typedef struct Material {
+    float Diffuse[4];
+} Material;
+
+/**
+ * @brief Small cluster of consecutive mesh triangles with bounds for culling. Normal cone
+ *        is stored as axis and sine of its half angle widened by 90 degrees, cutoff of 1 never culls.
+ * 
+ */
+typedef struct Meshlet {
+    uint32_t FirstIndex;
+    uint32_t NumIndices;
+    float BoundsMin[3];
+    float BoundsMax[3];
+    float Sphere[4];
+    float ConeAxis[3];
+    float ConeCutoff;
+} Meshlet;
+
+/**
+ * @brief Index range of one level of detail. First index is relative to the mesh index range,
+ *        error is the largest deviation from the full detail surface in mesh units.
+ * 
+ */
+typedef struct MeshLod {
+    uint32_t FirstIndex;
+    uint32_t NumIndices;
+    float Error;
+} MeshLod;
+
+/**
+ * @brief CPU side mesh produced by importers, ready to be uploaded. Simplified levels are kept
+ *        in LodIndices and are stored right after the full detail indices when baked.
+ * 
+ */
+typedef struct MeshData {
+    Vertex* Vertices;
+    unsigned* Indices;
+    unsigned NumVertices;
+    unsigned NumIndices;
+    Meshlet* Meshlets;
+    unsigned NumMeshlets;
+    unsigned* LodIndices;
+    unsigned NumLodIndices;
+    unsigned NumLods;
+    MeshLod Lods[MESH_MAX_LODS];
+    unsigned Material;
+    float Acmr;
+    float Atvr;
+    // NOTE(Jovan): Worker time spent in ProcessModelData, reported through the load profile
+    double ProcessSeconds;
+} MeshData;
+
+/**
+ * @brief CPU side model produced by importers. Materials are deduplicated, meshes refer to them by index.
+ *        Mesh table, mesh arrays and materials all live in the staging arena and are released together.
+ * 
+ */
+typedef struct ModelData {
+    unsigned NumMeshes;
+    MeshData* Meshes;
+    unsigned NumMaterials;
+    Material* Materials;
+    Arena Staging;
+} ModelData;
+
+/**
+ * @brief Key of one file read by an importer. Size, modification time and hash are all taken
+ *        from the view the importer parsed, so a save during import can't pair new key with old contents.
+ * 
+ */
+typedef struct SourceKey {
+    char Path[MODEL_SOURCE_MAX_PATH];
+    uint64_t Size;
+    int64_t ModifiedTime;
+    uint64_t Hash;
+} SourceKey;
+
+/**
+ * @brief Every file an import depended on. Incomplete lists, e.g. with too many files or too long paths,
+ *        can't validate a cache and keep the model from being cached.
+ * 
+ */
+typedef struct ModelSources {
+    unsigned NumSources;
+    unsigned Incomplete;
+    SourceKey Sources[MAX_MODEL_SOURCES];
+} ModelSources;
+
+/**
+ * @brief Internal representation of each model mesh, a range inside the shared model buffers.
+ *        Index count covers every level of detail, meshlets only cover the full detail level.
  * 
  */
 typedef struct MeshBuffer {
-    unsigned VAO;
-    unsigned VBO;
-    unsigned EBO;
+    unsigned FirstVertex;
     unsigned VerticesCount;
+    unsigned IndexOffset;
     unsigned IndicesCount;
+    GLenum IndexType;
+    unsigned FirstMeshlet;
+    unsigned NumMeshlets;
+    unsigned NumLods;
+    unsigned CurrentLod;
+    MeshLod Lods[MESH_MAX_LODS];
+    unsigned Material;
+    float BoundsMin[3];
+    float BoundsMax[3];
+    float Acmr;
+    float Atvr;
 } MeshBuffer;
 
 /**
- * @brief Model struct
+ * @brief Model struct. All meshes share one VBO, EBO and VAO and are drawn by offset.
+ *        Meshes become resident in order, so resident meshes are always the first NumResident.
+ *        Meshes are sorted by material, each run of meshes sharing material and index type is one draw call.
  * 
  */
 typedef struct Model {
+    unsigned VAO;
+    unsigned VBO;
+    unsigned EBO;
+    unsigned MaterialUBO;
+    unsigned NumMaterials;
+    unsigned VertexFormat;
+    float PosScale[3];
+    float PosOffset[3];
     unsigned NumMeshes;
+    unsigned NumResident;
     MeshBuffer* MeshBuffers;
+    // NOTE(Jovan): Per mesh arguments of glMultiDrawElementsBaseVertex
+    GLsizei* DrawCounts;
+    const void** DrawOffsets;
+    GLint* DrawBaseVertices;
+    unsigned NumMeshlets;
+    Meshlet* Meshlets;
+    // NOTE(Jovan): Scratch draw arguments of RenderModelCulled, sized for every meshlet drawn separately
+    GLsizei* CullCounts;
+    const void** CullOffsets;
+    GLint* CullBaseVertices;
+    // NOTE(Jovan): Filled by the load, meshes index like MeshBuffers. Released with the model.
+    LoadProfile Profile;
+    // NOTE(Jovan): Files the model was built from, for watching them
+    ModelSources Sources;
 } Model;
 
-#endif
+/**
+ * @brief Camera state used for culling and level of detail selection
+ * 
+ */
+typedef struct RenderView {
+    mat4 ViewProjection;
+    vec3 CameraPosition;
+    // NOTE(Jovan): Pixels covered by one unit at unit distance, projection[1][1] times half the viewport height.
+    // Zero keeps every mesh at full detail.
+    float PixelScale;
+} RenderView;
 
 /**
- * @brief Loads model
+ * @brief Loads model. Time and bytes of every load stage are kept in model->Profile.
  * 
  * @param filePath Relative model file path
  * @param model Model struct which will contain result. Should be allocated beforehand.
@@ -64,8 +255,147 @@ int LoadModel(const char* filePath, Model* model);
 void FreeModelResources(Model* model);
 
 /**
- * @brief Attempts to render all model meshes via GL interface
+ * @brief Attempts to render all resident model meshes at full detail via GL interface, with one draw call
+ *        per run of meshes sharing material and index type. Binds the material table to the Materials block
+ *        and sets uMaterial, uPosScale and uPosOffset of the program set with UseShaderProgram, which are
+ *        reset afterwards.
  * 
  * @param model Model to be rendered
  */
-void RenderModel(const Model* model);
\ No newline at end of file
+void RenderModel(const Model* model);
+
+/**
+ * @brief Renders resident meshes of model, skipping meshlets outside the view frustum and meshlets
+ *        whose normal cone faces away from the camera. Consecutive visible meshlets are merged into
+ *        one draw range. Each mesh draws the coarsest level of detail whose projected error stays
+ *        under LOD_PIXEL_ERROR, simplified levels are culled per mesh only. Cone test and error
+ *        projection run in model space and assume the model matrix does not shear or scale non-uniformly.
+ * 
+ * @param model Model to be rendered
+ * @param view Camera used for culling
+ * @param modelMatrix Model to world transform, same as the one passed to the shader
+ * @return unsigned Number of full detail meshlets drawn
+ */
+unsigned RenderModelCulled(Model* model, const RenderView* view, mat4 modelMatrix);
+
+struct BakedModel;
+
+/**
+ * @brief Loads model from its mesh cache, or imports and caches it if the cache is missing or stale.
+ *        Cache is stale once any file the import read has changed. Does not touch GL, safe to call from worker threads.
+ * 
+ * @param filePath Relative model file path
+ * @param baked Result, must be freed with FreeBakedModel
+ * @param profile Receives stage timings and mesh table sized for the baked meshes, may be NULL
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ImportBakedModel(const char* filePath, struct BakedModel* baked, LoadProfile* profile);
+
+/**
+ * @brief Fills mesh table, draw arguments and vertex layout of model from baked model.
+ *        Does not touch GL, safe to call from worker threads.
+ * 
+ * @param baked Baked model
+ * @param model Model struct which will contain result
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int InitModelMeshes(const struct BakedModel* baked, Model* model);
+
+/**
+ * @brief Creates VBO and EBO sized for the whole model without filling them, and the material
+ *        uniform buffer with its contents. Does not create the VAO, so it can run on any context
+ *        sharing objects with the render context.
+ * 
+ * @param baked Baked model
+ * @param model Model initialized with InitModelMeshes, receives buffer names
+ * @param profile Receives buffer creation time as upload, may be NULL
+ */
+void CreateModelBuffers(const struct BakedModel* baked, Model* model, LoadProfile* profile);
+
+/**
+ * @brief Copies vertices and indices of one baked mesh into model buffers
+ * 
+ * @param baked Baked model
+ * @param meshIdx Mesh index
+ * @param model Model with buffers created by CreateModelBuffers
+ * @param profile Receives upload time and bytes of the mesh, may be NULL
+ */
+void UploadMeshBuffers(const struct BakedModel* baked, unsigned meshIdx, const Model* model, LoadProfile* profile);
+
+/**
+ * @brief Creates VAO over model buffers. VAOs are not shared between contexts,
+ *        so this must run on the render context.
+ * 
+ * @param model Model with buffers created by CreateModelBuffers
+ */
+void CreateModelVertexArray(Model* model);
+
+/**
+ * @brief Binds VBO and EBO of model again with its VAO bound, so the render context observes mesh data
+ *        written by the upload context. Call after the fences of those writes have passed.
+ * 
+ * @param model Model with VAO created by CreateModelVertexArray
+ */
+void AttachModelBuffers(const Model* model);
+
+/**
+ * @brief Replaces one entry of the model material table. Vertex data is not touched.
+ * 
+ * @param model Model with buffers created by CreateModelBuffers
+ * @param materialIdx Index of material to be replaced
+ * @param material New material parameters
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SetModelMaterial(const Model* model, unsigned materialIdx, const Material* material);
+
+/**
+ * @brief Size of one vertex in given format
+ * 
+ * @param format One of VERTEX_FORMAT_ values
+ * @return unsigned Vertex stride in bytes, 0 for unknown format
+ */
+unsigned VertexFormatStride(unsigned format);
+
+/**
+ * @brief Reserves staging arena sized from the totals of the whole scene and allocates mesh
+ *        array of model data from it. Mesh contents are left zeroed.
+ * 
+ * @param data Zeroed model data to be filled
+ * @param numMeshes Number of meshes
+ * @param numVertices Total vertices of all meshes
+ * @param numIndices Total indices of all meshes
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int AllocModelData(ModelData* data, unsigned numMeshes, uint64_t numVertices, uint64_t numIndices);
+
+/**
+ * @brief Finds material in the model material table or appends it. Tables are capped at
+ *        MAX_MATERIALS, further distinct materials fall back to the first one.
+ * 
+ * @param data Model data
+ * @param material Material parameters
+ * @param materialIdx Output material index
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int AddModelMaterial(ModelData* data, const Material* material, unsigned* materialIdx);
+
+struct VfsFile;
+
+/**
+ * @brief Records key of a file opened by an importer. Opening the same path again replaces its key,
+ *        the last opened view is the one parsed.
+ * 
+ * @param sources Source list of the import
+ * @param filePath Relative file path
+ * @param file Opened file
+ */
+void AddModelSource(ModelSources* sources, const char* filePath, const struct VfsFile* file);
+
+/**
+ * @brief Frees all memory owned by model data in one arena release. Does not free data struct itself.
+ * 
+ * @param data Model data to be deallocated
+ */
+void FreeModelData(ModelData* data);
+
+#endif
@@ -0,0 +1,668 @@
+#include "objloader.h"
+#include "vfs.h"
+#include "jobs.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+
+#define OBJ_MAX_NAME 256
+
+typedef struct ObjUseMtl {
+    unsigned FirstIndex;
+    const char* Name;
+    unsigned NameLength;
+} ObjUseMtl;
+
+/**
+ * @brief Parse result of one line-aligned part of the file
+ *
+ */
+typedef struct ObjChunk {
+    const char* Begin;
+    const char* End;
+    float* Positions;
+    unsigned NumPositions;
+    unsigned CapPositions;
+    // NOTE(Jovan): Triangle corner position indices, absolute unless listed in Fixups
+    unsigned* Indices;
+    unsigned NumIndices;
+    unsigned CapIndices;
+    unsigned* Fixups;
+    unsigned NumFixups;
+    unsigned CapFixups;
+    ObjUseMtl* UseMtls;
+    unsigned NumUseMtls;
+    unsigned CapUseMtls;
+    const char* MtlLib;
+    unsigned MtlLibLength;
+    unsigned PositionBase;
+    int Failed;
+} ObjChunk;
+
+typedef struct ObjMaterial {
+    const char* Name;
+    unsigned NameLength;
+    float Diffuse[3];
+} ObjMaterial;
+
+typedef struct ObjSegment {
+    const ObjChunk* Chunk;
+    unsigned FirstIndex;
+    unsigned EndIndex;
+    int Material;
+} ObjSegment;
+
+static const double sPow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+int
+IsObjFile(const char* filePath) {
+    size_t Length = strlen(filePath);
+    if(Length < 4) {
+        return 0;
+    }
+
+    const char* Ext = filePath + Length - 4;
+    return Ext[0] == '.' && tolower((unsigned char)Ext[1]) == 'o'
+        && tolower((unsigned char)Ext[2]) == 'b' && tolower((unsigned char)Ext[3]) == 'j';
+}
+
+static int
+Reserve(void** data, unsigned* capacity, unsigned needed, size_t elementSize) {
+    if(needed <= *capacity) {
+        return 1;
+    }
+
+    unsigned NewCapacity = *capacity ? *capacity : 256;
+    while(NewCapacity < needed) {
+        NewCapacity *= 2;
+    }
+
+    void* NewData = realloc(*data, NewCapacity * elementSize);
+    if(!NewData) {
+        return 0;
+    }
+
+    *data = NewData;
+    *capacity = NewCapacity;
+    return 1;
+}
+
+static const char*
+SkipSpaces(const char* p, const char* end) {
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+static const char*
+SkipLine(const char* p, const char* end) {
+    const char* NewLine = (const char*)memchr(p, '\n', end - p);
+    return NewLine ? NewLine + 1 : end;
+}
+
+/**
+ * @brief Locale independent float parser. Exact for up to 19 significant digits
+ *        and decimal exponents within double's exactly representable powers of ten.
+ *
+ * @return const char* Position after the number, NULL if there is no number
+ */
+static const char*
+ParseFloat(const char* p, const char* end, float* out) {
+    int Negative = 0;
+    if(p < end && (*p == '-' || *p == '+')) {
+        Negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t Mantissa = 0;
+    int Exponent = 0;
+    int Digits = 0;
+    int Any = 0;
+    for(; p < end && *p >= '0' && *p <= '9'; ++p) {
+        Any = 1;
+        if(Digits < 19) {
+            Mantissa = Mantissa * 10 + (*p - '0');
+            Digits += Mantissa != 0;
+        } else {
+            ++Exponent;
+        }
+    }
+
+    if(p < end && *p == '.') {
+        for(++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            Any = 1;
+            if(Digits < 19) {
+                Mantissa = Mantissa * 10 + (*p - '0');
+                Digits += Mantissa != 0;
+                --Exponent;
+            }
+        }
+    }
+
+    if(!Any) {
+        return NULL;
+    }
+
+    if(p < end && (*p == 'e' || *p == 'E')) {
+        const char* ExpStart = p++;
+        int ExpNegative = 0;
+        if(p < end && (*p == '-' || *p == '+')) {
+            ExpNegative = *p == '-';
+            ++p;
+        }
+
+        if(p < end && *p >= '0' && *p <= '9') {
+            int ExpValue = 0;
+            for(; p < end && *p >= '0' && *p <= '9'; ++p) {
+                if(ExpValue < 10000) {
+                    ExpValue = ExpValue * 10 + (*p - '0');
+                }
+            }
+            Exponent += ExpNegative ? -ExpValue : ExpValue;
+        } else {
+            p = ExpStart;
+        }
+    }
+
+    double Value = (double)Mantissa;
+    if(Mantissa) {
+        if(Exponent < 0 && Exponent >= -22) {
+            Value /= sPow10[-Exponent];
+        } else if(Exponent > 0 && Exponent <= 22) {
+            Value *= sPow10[Exponent];
+        } else if(Exponent) {
+            Value *= pow(10.0, Exponent);
+        }
+    }
+
+    *out = (float)(Negative ? -Value : Value);
+    return p;
+}
+
+static const char*
+ParseInt(const char* p, const char* end, long* out) {
+    int Negative = 0;
+    if(p < end && (*p == '-' || *p == '+')) {
+        Negative = *p == '-';
+        ++p;
+    }
+
+    if(p >= end || *p < '0' || *p > '9') {
+        return NULL;
+    }
+
+    long Value = 0;
+    for(; p < end && *p >= '0' && *p <= '9'; ++p) {
+        Value = Value * 10 + (*p - '0');
+    }
+
+    *out = Negative ? -Value : Value;
+    return p;
+}
+
+static int
+PushIndex(ObjChunk* chunk, long raw) {
+    if(!Reserve((void**)&chunk->Indices, &chunk->CapIndices, chunk->NumIndices + 1, sizeof(unsigned))) {
+        return 0;
+    }
+
+    if(raw > 0) {
+        chunk->Indices[chunk->NumIndices++] = (unsigned)(raw - 1);
+        return 1;
+    }
+
+    // NOTE(Jovan): Relative index, chunk base is not known until all chunks are parsed
+    if(!Reserve((void**)&chunk->Fixups, &chunk->CapFixups, chunk->NumFixups + 1, sizeof(unsigned))) {
+        return 0;
+    }
+    chunk->Fixups[chunk->NumFixups++] = chunk->NumIndices;
+    chunk->Indices[chunk->NumIndices++] = (unsigned)((long)chunk->NumPositions + raw);
+    return 1;
+}
+
+static const char*
+ParseFace(ObjChunk* chunk, const char* p, const char* end) {
+    long First = 0, Prev = 0;
+    unsigned NumCorners = 0;
+    for(;;) {
+        p = SkipSpaces(p, end);
+        if(p >= end || *p == '\n' || *p == '#') {
+            break;
+        }
+
+        long Raw;
+        p = ParseInt(p, end, &Raw);
+        if(!p || !Raw) {
+            return NULL;
+        }
+
+        // NOTE(Jovan): Texture coordinate and normal references are not part of the vertex layout
+        while(p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+            ++p;
+        }
+
+        if(NumCorners == 0) {
+            First = Raw;
+        } else if(NumCorners >= 2) {
+            if(!PushIndex(chunk, First) || !PushIndex(chunk, Prev) || !PushIndex(chunk, Raw)) {
+                return NULL;
+            }
+        }
+        Prev = Raw;
+        ++NumCorners;
+    }
+
+    return NumCorners >= 3 ? p : NULL;
+}
+
+static const char*
+ParseName(const char* p, const char* end, const char** name, unsigned* length) {
+    p = SkipSpaces(p, end);
+    const char* Start = p;
+    while(p < end && *p != '\n' && *p != '\r' && *p != '#') {
+        ++p;
+    }
+
+    const char* Last = p;
+    while(Last > Start && (Last[-1] == ' ' || Last[-1] == '\t')) {
+        --Last;
+    }
+
+    *name = Start;
+    *length = (unsigned)(Last - Start);
+    return p;
+}
+
+static int
+IsKeyword(const char* p, const char* end, const char* keyword, unsigned length) {
+    return (size_t)(end - p) > length && !memcmp(p, keyword, length)
+        && (p[length] == ' ' || p[length] == '\t');
+}
+
+static void
+ParseChunk(void* data, unsigned index) {
+    ObjChunk* Chunk = &((ObjChunk*)data)[index];
+    const char* p = Chunk->Begin;
+    const char* End = Chunk->End;
+
+    while(p < End) {
+        const char* LineStart = p;
+        p = SkipSpaces(p, End);
+        if(p >= End) {
+            break;
+        }
+
+        if(p[0] == 'v' && p + 1 < End && (p[1] == ' ' || p[1] == '\t')) {
+            if(!Reserve((void**)&Chunk->Positions, &Chunk->CapPositions, Chunk->NumPositions + 1, 3 * sizeof(float))) {
+                Chunk->Failed = 1;
+                return;
+            }
+
+            float* Position = &Chunk->Positions[3 * Chunk->NumPositions];
+            p += 2;
+            for(unsigned Axis = 0; Axis < 3 && p; ++Axis) {
+                p = ParseFloat(SkipSpaces(p, End), End, &Position[Axis]);
+            }
+
+            if(!p) {
+                Chunk->Failed = 1;
+                Chunk->Begin = LineStart;
+                return;
+            }
+            ++Chunk->NumPositions;
+        } else if(p[0] == 'f' && p + 1 < End && (p[1] == ' ' || p[1] == '\t')) {
+            p = ParseFace(Chunk, p + 2, End);
+            if(!p) {
+                Chunk->Failed = 1;
+                Chunk->Begin = LineStart;
+                return;
+            }
+        } else if(IsKeyword(p, End, "usemtl", 6)) {
+            if(!Reserve((void**)&Chunk->UseMtls, &Chunk->CapUseMtls, Chunk->NumUseMtls + 1, sizeof(ObjUseMtl))) {
+                Chunk->Failed = 1;
+                return;
+            }
+
+            ObjUseMtl* UseMtl = &Chunk->UseMtls[Chunk->NumUseMtls++];
+            UseMtl->FirstIndex = Chunk->NumIndices;
+            p = ParseName(p + 6, End, &UseMtl->Name, &UseMtl->NameLength);
+        } else if(IsKeyword(p, End, "mtllib", 6) && !Chunk->MtlLib) {
+            p = ParseName(p + 6, End, &Chunk->MtlLib, &Chunk->MtlLibLength);
+        }
+
+        p = SkipLine(p, End);
+    }
+}
+
+static void
+FreeChunks(ObjChunk* chunks, unsigned numChunks) {
+    for(unsigned ChunkIdx = 0; ChunkIdx < numChunks; ++ChunkIdx) {
+        free(chunks[ChunkIdx].Positions);
+        free(chunks[ChunkIdx].Indices);
+        free(chunks[ChunkIdx].Fixups);
+        free(chunks[ChunkIdx].UseMtls);
+    }
+    free(chunks);
+}
+
+static int
+FindMaterial(const ObjMaterial* materials, unsigned numMaterials, const char* name, unsigned length) {
+    for(unsigned MaterialIdx = 0; MaterialIdx < numMaterials; ++MaterialIdx) {
+        if(materials[MaterialIdx].NameLength == length && !memcmp(materials[MaterialIdx].Name, name, length)) {
+            return (int)MaterialIdx;
+        }
+    }
+    return -1;
+}
+
+static void
+LoadMtlDiffuse(const char* objPath, const char* mtlLib, unsigned mtlLibLength,
+               ObjMaterial* materials, unsigned numMaterials, ModelSources* sources) {
+    char MtlPath[OBJ_MAX_NAME * 2];
+    const char* Slash = strrchr(objPath, '/');
+    const char* BackSlash = strrchr(objPath, '\\');
+    if(BackSlash > Slash) {
+        Slash = BackSlash;
+    }
+
+    size_t DirLength = Slash ? (size_t)(Slash - objPath + 1) : 0;
+    if(DirLength + mtlLibLength + 1 > sizeof(MtlPath)) {
+        return;
+    }
+    memcpy(MtlPath, objPath, DirLength);
+    memcpy(MtlPath + DirLength, mtlLib, mtlLibLength);
+    MtlPath[DirLength + mtlLibLength] = '\0';
+
+    VfsFile File;
+    if(!VfsOpenFile(MtlPath, &File)) {
+        fprintf(stderr, "Failed to open material library %s, using default colors.\n", MtlPath);
+        return;
+    }
+    AddModelSource(sources, MtlPath, &File);
+
+    const char* p = File.Data;
+    const char* End = File.Data + File.Size;
+    int Current = -1;
+    while(p < End) {
+        p = SkipSpaces(p, End);
+        if(IsKeyword(p, End, "newmtl", 6)) {
+            const char* Name;
+            unsigned NameLength;
+            p = ParseName(p + 6, End, &Name, &NameLength);
+            Current = FindMaterial(materials, numMaterials, Name, NameLength);
+        } else if(Current >= 0 && IsKeyword(p, End, "Kd", 2)) {
+            float Diffuse[3];
+            p += 2;
+            for(unsigned Channel = 0; Channel < 3 && p; ++Channel) {
+                p = ParseFloat(SkipSpaces(p, End), End, &Diffuse[Channel]);
+            }
+
+            if(!p) {
+                break;
+            }
+            memcpy(materials[Current].Diffuse, Diffuse, sizeof(Diffuse));
+        }
+        p = SkipLine(p, End);
+    }
+
+    VfsCloseFile(&File);
+}
+
+static int
+BuildMesh(Arena* staging, MeshData* mesh, const ObjSegment* segments, unsigned numSegments, int material,
+          const float* positions, unsigned numPositions, unsigned* remap, unsigned* used) {
+    unsigned NumIndices = 0;
+    for(unsigned SegmentIdx = 0; SegmentIdx < numSegments; ++SegmentIdx) {
+        if(segments[SegmentIdx].Material == material) {
+            NumIndices += segments[SegmentIdx].EndIndex - segments[SegmentIdx].FirstIndex;
+        }
+    }
+
+    mesh->Indices = (unsigned*)ArenaAlloc(staging, NumIndices * sizeof(unsigned));
+    if(!mesh->Indices) {
+        return 0;
+    }
+
+    // NOTE(Jovan): Positions are renumbered in order of first use, which also keeps vertex fetches local
+    unsigned NumVertices = 0;
+    int Valid = 1;
+    for(unsigned SegmentIdx = 0; SegmentIdx < numSegments; ++SegmentIdx) {
+        const ObjSegment* Segment = &segments[SegmentIdx];
+        if(Segment->Material != material) {
+            continue;
+        }
+
+        for(unsigned Idx = Segment->FirstIndex; Idx < Segment->EndIndex; ++Idx) {
+            unsigned Position = Segment->Chunk->Indices[Idx];
+            if(Position >= numPositions) {
+                Valid = 0;
+                break;
+            }
+
+            if(remap[Position] == ~0u) {
+                remap[Position] = NumVertices;
+                used[NumVertices++] = Position;
+            }
+            mesh->Indices[mesh->NumIndices++] = remap[Position];
+        }
+    }
+
+    for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+        remap[used[VertIdx]] = ~0u;
+    }
+
+    if(!Valid) {
+        fprintf(stderr, "OBJ face references missing vertex.\n");
+        return 0;
+    }
+
+    mesh->Vertices = (Vertex*)ArenaAlloc(staging, NumVertices * sizeof(Vertex));
+    if(!mesh->Vertices) {
+        return 0;
+    }
+
+    for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+        Vertex CurrVertex = { 0 };
+        memcpy(CurrVertex.Position, &positions[3 * used[VertIdx]], 3 * sizeof(float));
+        mesh->Vertices[VertIdx] = CurrVertex;
+    }
+    mesh->NumVertices = NumVertices;
+    return 1;
+}
+
+static int
+BuildModelData(const char* filePath, ObjChunk* chunks, unsigned numChunks, ModelData* data, ModelSources* sources) {
+    unsigned NumPositions = 0, NumSegments = 0, NumIndices = 0;
+    const char* MtlLib = NULL;
+    unsigned MtlLibLength = 0;
+    for(unsigned ChunkIdx = 0; ChunkIdx < numChunks; ++ChunkIdx) {
+        ObjChunk* Chunk = &chunks[ChunkIdx];
+        Chunk->PositionBase = NumPositions;
+        for(unsigned FixupIdx = 0; FixupIdx < Chunk->NumFixups; ++FixupIdx) {
+            Chunk->Indices[Chunk->Fixups[FixupIdx]] += NumPositions;
+        }
+
+        NumPositions += Chunk->NumPositions;
+        NumIndices += Chunk->NumIndices;
+        NumSegments += Chunk->NumUseMtls + 1;
+        if(!MtlLib && Chunk->MtlLib) {
+            MtlLib = Chunk->MtlLib;
+            MtlLibLength = Chunk->MtlLibLength;
+        }
+    }
+
+    if(!NumIndices) {
+        fprintf(stderr, "OBJ file %s contains no faces.\n", filePath);
+        return 0;
+    }
+
+    float* Positions = (float*)malloc(3 * (size_t)NumPositions * sizeof(float));
+    ObjSegment* Segments = (ObjSegment*)malloc(NumSegments * sizeof(ObjSegment));
+    ObjMaterial* Materials = (ObjMaterial*)malloc(NumSegments * sizeof(ObjMaterial));
+    unsigned* Remap = (unsigned*)malloc(NumPositions * sizeof(unsigned));
+    unsigned* Used = (unsigned*)malloc(NumPositions * sizeof(unsigned));
+    int* MeshMaterials = (int*)malloc((NumSegments + 1) * sizeof(int));
+    int Result = 0;
+    if(!Positions || !Segments || !Materials || !Remap || !Used || !MeshMaterials) {
+        fprintf(stderr, "Failed to allocate OBJ model data.\n");
+        goto cleanup;
+    }
+
+    for(unsigned ChunkIdx = 0; ChunkIdx < numChunks; ++ChunkIdx) {
+        if(!chunks[ChunkIdx].NumPositions) {
+            continue;
+        }
+        memcpy(&Positions[3 * chunks[ChunkIdx].PositionBase], chunks[ChunkIdx].Positions,
+               3 * (size_t)chunks[ChunkIdx].NumPositions * sizeof(float));
+    }
+    memset(Remap, 0xFF, NumPositions * sizeof(unsigned));
+
+    // NOTE(Jovan): Faces before the first usemtl continue the previous chunk's material
+    unsigned NumMaterials = 0, NumMeshes = 0;
+    int CurrMaterial = -1;
+    NumSegments = 0;
+    for(unsigned ChunkIdx = 0; ChunkIdx < numChunks; ++ChunkIdx) {
+        const ObjChunk* Chunk = &chunks[ChunkIdx];
+        unsigned First = 0;
+        for(unsigned UseIdx = 0; UseIdx <= Chunk->NumUseMtls; ++UseIdx) {
+            unsigned End = UseIdx < Chunk->NumUseMtls ? Chunk->UseMtls[UseIdx].FirstIndex : Chunk->NumIndices;
+            if(End > First) {
+                ObjSegment* Segment = &Segments[NumSegments++];
+                Segment->Chunk = Chunk;
+                Segment->FirstIndex = First;
+                Segment->EndIndex = End;
+                Segment->Material = CurrMaterial;
+
+                int Known = 0;
+                for(unsigned MeshIdx = 0; MeshIdx < NumMeshes && !Known; ++MeshIdx) {
+                    Known = MeshMaterials[MeshIdx] == CurrMaterial;
+                }
+                if(!Known) {
+                    MeshMaterials[NumMeshes++] = CurrMaterial;
+                }
+            }
+
+            if(UseIdx < Chunk->NumUseMtls) {
+                const ObjUseMtl* UseMtl = &Chunk->UseMtls[UseIdx];
+                CurrMaterial = FindMaterial(Materials, NumMaterials, UseMtl->Name, UseMtl->NameLength);
+                if(CurrMaterial < 0) {
+                    ObjMaterial* NewMaterial = &Materials[NumMaterials];
+                    NewMaterial->Name = UseMtl->Name;
+                    NewMaterial->NameLength = UseMtl->NameLength;
+                    NewMaterial->Diffuse[0] = NewMaterial->Diffuse[1] = NewMaterial->Diffuse[2] = OBJ_DEFAULT_DIFFUSE;
+                    CurrMaterial = (int)NumMaterials++;
+                }
+                First = End;
+            }
+        }
+    }
+
+    if(MtlLib && NumMaterials) {
+        LoadMtlDiffuse(filePath, MtlLib, MtlLibLength, Materials, NumMaterials, sources);
+    }
+
+    // NOTE(Jovan): Meshes renumber positions separately, a position shared by several materials is counted once here
+    if(!AllocModelData(data, NumMeshes, NumPositions, NumIndices)) {
+        goto cleanup;
+    }
+
+    // NOTE(Jovan): Named materials with equal parameters end up sharing one table entry
+    for(unsigned MeshIdx = 0; MeshIdx < NumMeshes; ++MeshIdx) {
+        int MaterialIdx = MeshMaterials[MeshIdx];
+        Material CurrMaterial = { { OBJ_DEFAULT_DIFFUSE, OBJ_DEFAULT_DIFFUSE, OBJ_DEFAULT_DIFFUSE, 1.0f } };
+        if(MaterialIdx >= 0) {
+            memcpy(CurrMaterial.Diffuse, Materials[MaterialIdx].Diffuse, sizeof(Materials[MaterialIdx].Diffuse));
+        }
+        if(!AddModelMaterial(data, &CurrMaterial, &data->Meshes[MeshIdx].Material)
+           || !BuildMesh(&data->Staging, &data->Meshes[MeshIdx], Segments, NumSegments, MaterialIdx,
+                         Positions, NumPositions, Remap, Used)) {
+            fprintf(stderr, "Failed to build OBJ mesh %u.\n", MeshIdx);
+            FreeModelData(data);
+            goto cleanup;
+        }
+    }
+    Result = 1;
+
+cleanup:
+    free(Positions);
+    free(Segments);
+    free(Materials);
+    free(Remap);
+    free(Used);
+    free(MeshMaterials);
+    return Result;
+}
+
+int
+LoadObjModelData(const char* filePath, ModelData* data, ModelSources* sources) {
+    VfsFile File;
+    if(!VfsOpenFile(filePath, &File)) {
+        fprintf(stderr, "Failed to open OBJ file %s.\n", filePath);
+        return LOAD_FAIL;
+    }
+    AddModelSource(sources, filePath, &File);
+
+    unsigned MaxChunks = (JobWorkerCount() + 1) * OBJ_CHUNKS_PER_THREAD;
+    unsigned NumChunks = (unsigned)(File.Size / OBJ_MIN_CHUNK_SIZE) + 1;
+    if(NumChunks > MaxChunks) {
+        NumChunks = MaxChunks;
+    }
+
+    ObjChunk* Chunks = (ObjChunk*)calloc(NumChunks, sizeof(ObjChunk));
+    if(!Chunks) {
+        fprintf(stderr, "Failed to allocate OBJ chunks.\n");
+        VfsCloseFile(&File);
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Split at line boundaries so every record lies in exactly one chunk
+    const char* End = File.Data + File.Size;
+    const char* Begin = File.Data;
+    unsigned ActualChunks = 0;
+    for(unsigned ChunkIdx = 0; ChunkIdx < NumChunks && Begin < End; ++ChunkIdx) {
+        const char* ChunkEnd = ChunkIdx + 1 == NumChunks ? End : File.Data + (File.Size / NumChunks) * (ChunkIdx + 1);
+        if(ChunkEnd < Begin) {
+            ChunkEnd = Begin;
+        }
+        ChunkEnd = SkipLine(ChunkEnd, End);
+        Chunks[ActualChunks].Begin = Begin;
+        Chunks[ActualChunks].End = ChunkEnd;
+        ++ActualChunks;
+        Begin = ChunkEnd;
+    }
+
+    JobParallelFor(ActualChunks, ParseChunk, Chunks);
+
+    int Result = LOAD_SUCCESS;
+    unsigned NumPositions = 0, NumIndices = 0;
+    for(unsigned ChunkIdx = 0; ChunkIdx < ActualChunks; ++ChunkIdx) {
+        const ObjChunk* Chunk = &Chunks[ChunkIdx];
+        if(Chunk->Failed) {
+            const char* LineEnd = (const char*)memchr(Chunk->Begin, '\n', Chunk->End - Chunk->Begin);
+            int Length = (int)((LineEnd ? LineEnd : Chunk->End) - Chunk->Begin);
+            fprintf(stderr, "Failed to parse OBJ record: %.*s\n", Length > 80 ? 80 : Length, Chunk->Begin);
+            Result = LOAD_FAIL;
+        }
+        NumPositions += Chunk->NumPositions;
+        NumIndices += Chunk->NumIndices;
+    }
+
+    if(Result == LOAD_SUCCESS) {
+        Result = BuildModelData(filePath, Chunks, ActualChunks, data, sources) ? LOAD_SUCCESS : LOAD_FAIL;
+    }
+
+    if(Result == LOAD_SUCCESS) {
+        fprintf(stdout, "Parsed %s: %u positions, %u triangles in %u chunks.\n",
+                filePath, NumPositions, NumIndices / 3, ActualChunks);
+    }
+
+    FreeChunks(Chunks, NumChunks);
+    VfsCloseFile(&File);
+    return Result;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file objloader.h
+ * @author Jovan Ivosevic
+ * @brief Native multithreaded Wavefront OBJ importer
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "model.h"
+
+// NOTE(Jovan): Chunks smaller than this are not worth handing to another thread
+#define OBJ_MIN_CHUNK_SIZE (64 * 1024)
+#define OBJ_CHUNKS_PER_THREAD 4
+#define OBJ_DEFAULT_DIFFUSE 0.6f
+
+/**
+ * @brief Checks whether file should be handled by the native OBJ importer
+ *
+ * @param filePath Model file path
+ * @return int 1 if path has .obj extension, 0 otherwise
+ */
+int IsObjFile(const char* filePath);
+
+/**
+ * @brief Imports OBJ file into GPU-ready model data. File is viewed in the asset pack or memory mapped, and
+ *        parsed in line-aligned chunks on the job system. Polygons are triangulated
+ *        as fans, faces are grouped into one mesh per material, and diffuse colors
+ *        are read from the referenced mtllib when present. Only positions are read, vn and vt
+ *        records and face references to them are skipped, normals and tangents are generated in processing.
+ *
+ * @param filePath Relative model file path
+ * @param data Model data which will contain result
+ * @param sources Receives keys of the OBJ file and its mtllib, taken from the parsed views
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int LoadObjModelData(const char* filePath, ModelData* data, ModelSources* sources);
+
+#endif
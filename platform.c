@@ -0,0 +1,487 @@
+#include "platform.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+#ifdef _WIN32
+
+struct Thread {
+    HANDLE Handle;
+    ThreadFunc Func;
+    void* Arg;
+};
+
+struct Mutex {
+    SRWLOCK Lock;
+};
+
+struct CondVar {
+    CONDITION_VARIABLE Cond;
+};
+
+int
+PlatformMapFile(const char* filePath, MappedFile* file) {
+    memset(file, 0, sizeof(MappedFile));
+    HANDLE File = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(File == INVALID_HANDLE_VALUE) {
+        return PLATFORM_FAIL;
+    }
+
+    LARGE_INTEGER Size;
+    FILETIME LastWriteTime;
+    if(!GetFileSizeEx(File, &Size) || !GetFileTime(File, NULL, NULL, &LastWriteTime)) {
+        CloseHandle(File);
+        return PLATFORM_FAIL;
+    }
+
+    file->FileHandle = File;
+    file->Size = (size_t)Size.QuadPart;
+    file->ModifiedTime = (int64_t)(((uint64_t)LastWriteTime.dwHighDateTime << 32) | LastWriteTime.dwLowDateTime);
+    // NOTE(Jovan): Empty files cannot be mapped, expose them as zero-sized views
+    if(!file->Size) {
+        return PLATFORM_SUCCESS;
+    }
+
+    HANDLE Mapping = CreateFileMappingA(File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(!Mapping) {
+        CloseHandle(File);
+        memset(file, 0, sizeof(MappedFile));
+        return PLATFORM_FAIL;
+    }
+
+    file->MappingHandle = Mapping;
+    file->Data = (const char*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!file->Data) {
+        PlatformUnmapFile(file);
+        return PLATFORM_FAIL;
+    }
+
+    return PLATFORM_SUCCESS;
+}
+
+void
+PlatformUnmapFile(MappedFile* file) {
+    if(file->Data) {
+        UnmapViewOfFile(file->Data);
+    }
+    if(file->MappingHandle) {
+        CloseHandle((HANDLE)file->MappingHandle);
+    }
+    if(file->FileHandle) {
+        CloseHandle((HANDLE)file->FileHandle);
+    }
+    memset(file, 0, sizeof(MappedFile));
+}
+
+int
+PlatformFileStat(const char* filePath, uint64_t* size, int64_t* modifiedTime) {
+    WIN32_FILE_ATTRIBUTE_DATA Attributes;
+    if(!GetFileAttributesExA(filePath, GetFileExInfoStandard, &Attributes)) {
+        return PLATFORM_FAIL;
+    }
+
+    *size = ((uint64_t)Attributes.nFileSizeHigh << 32) | Attributes.nFileSizeLow;
+    *modifiedTime = (int64_t)(((uint64_t)Attributes.ftLastWriteTime.dwHighDateTime << 32)
+                              | Attributes.ftLastWriteTime.dwLowDateTime);
+    return PLATFORM_SUCCESS;
+}
+
+int
+PlatformReplaceFile(const char* sourcePath, const char* destinationPath) {
+    return MoveFileExA(sourcePath, destinationPath, MOVEFILE_REPLACE_EXISTING) ? PLATFORM_SUCCESS : PLATFORM_FAIL;
+}
+
+void*
+PlatformAllocPages(size_t* size, int largePages) {
+    // NOTE(Jovan): Large pages need the lock pages privilege, without it the regular path is taken
+    SIZE_T LargePage = largePages ? GetLargePageMinimum() : 0;
+    if(LargePage) {
+        SIZE_T Rounded = (*size + LargePage - 1) & ~(LargePage - 1);
+        void* Memory = VirtualAlloc(NULL, Rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if(Memory) {
+            *size = Rounded;
+            return Memory;
+        }
+    }
+    return VirtualAlloc(NULL, *size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+void
+PlatformFreePages(void* memory, size_t size) {
+    if(memory) {
+        VirtualFree(memory, 0, MEM_RELEASE);
+    }
+}
+
+uint64_t
+PlatformTimerTicks(void) {
+    LARGE_INTEGER Ticks;
+    QueryPerformanceCounter(&Ticks);
+    return (uint64_t)Ticks.QuadPart;
+}
+
+uint64_t
+PlatformTimerFrequency(void) {
+    LARGE_INTEGER Frequency;
+    QueryPerformanceFrequency(&Frequency);
+    return (uint64_t)Frequency.QuadPart;
+}
+
+unsigned
+PlatformCpuCount(void) {
+    SYSTEM_INFO Info;
+    GetSystemInfo(&Info);
+    return Info.dwNumberOfProcessors ? Info.dwNumberOfProcessors : 1;
+}
+
+static unsigned __stdcall
+ThreadEntry(void* arg) {
+    Thread* Self = (Thread*)arg;
+    return (unsigned)Self->Func(Self->Arg);
+}
+
+Thread*
+ThreadCreate(ThreadFunc func, void* arg) {
+    Thread* Result = (Thread*)calloc(1, sizeof(Thread));
+    if(!Result) {
+        return NULL;
+    }
+
+    Result->Func = func;
+    Result->Arg = arg;
+    Result->Handle = (HANDLE)_beginthreadex(NULL, 0, ThreadEntry, Result, 0, NULL);
+    if(!Result->Handle) {
+        free(Result);
+        return NULL;
+    }
+
+    return Result;
+}
+
+void
+ThreadJoin(Thread* thread) {
+    WaitForSingleObject(thread->Handle, INFINITE);
+    CloseHandle(thread->Handle);
+    free(thread);
+}
+
+Mutex*
+MutexCreate(void) {
+    Mutex* Result = (Mutex*)calloc(1, sizeof(Mutex));
+    if(Result) {
+        InitializeSRWLock(&Result->Lock);
+    }
+    return Result;
+}
+
+void
+MutexDestroy(Mutex* mutex) {
+    free(mutex);
+}
+
+void
+MutexLock(Mutex* mutex) {
+    AcquireSRWLockExclusive(&mutex->Lock);
+}
+
+void
+MutexUnlock(Mutex* mutex) {
+    ReleaseSRWLockExclusive(&mutex->Lock);
+}
+
+CondVar*
+CondVarCreate(void) {
+    CondVar* Result = (CondVar*)calloc(1, sizeof(CondVar));
+    if(Result) {
+        InitializeConditionVariable(&Result->Cond);
+    }
+    return Result;
+}
+
+void
+CondVarDestroy(CondVar* condVar) {
+    free(condVar);
+}
+
+void
+CondVarWait(CondVar* condVar, Mutex* mutex) {
+    SleepConditionVariableSRW(&condVar->Cond, &mutex->Lock, INFINITE, 0);
+}
+
+void
+CondVarSignal(CondVar* condVar) {
+    WakeConditionVariable(&condVar->Cond);
+}
+
+void
+CondVarBroadcast(CondVar* condVar) {
+    WakeAllConditionVariable(&condVar->Cond);
+}
+
+long
+AtomicIncrement(volatile long* value) {
+    return InterlockedIncrement(value);
+}
+
+long
+AtomicDecrement(volatile long* value) {
+    return InterlockedDecrement(value);
+}
+
+long
+AtomicAdd(volatile long* value, long amount) {
+    return InterlockedExchangeAdd(value, amount) + amount;
+}
+
+long
+AtomicLoad(volatile long* value) {
+    return InterlockedCompareExchange(value, 0, 0);
+}
+
+void
+AtomicStore(volatile long* value, long newValue) {
+    InterlockedExchange(value, newValue);
+}
+
+#else
+
+struct Thread {
+    pthread_t Handle;
+    ThreadFunc Func;
+    void* Arg;
+};
+
+struct Mutex {
+    pthread_mutex_t Lock;
+};
+
+struct CondVar {
+    pthread_cond_t Cond;
+};
+
+int
+PlatformMapFile(const char* filePath, MappedFile* file) {
+    memset(file, 0, sizeof(MappedFile));
+    int Fd = open(filePath, O_RDONLY);
+    if(Fd < 0) {
+        return PLATFORM_FAIL;
+    }
+
+    struct stat Stat;
+    if(fstat(Fd, &Stat) != 0) {
+        close(Fd);
+        return PLATFORM_FAIL;
+    }
+
+    file->Size = (size_t)Stat.st_size;
+    file->ModifiedTime = (int64_t)Stat.st_mtim.tv_sec * 1000000000 + Stat.st_mtim.tv_nsec;
+    if(file->Size) {
+        void* Data = mmap(NULL, file->Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+        if(Data == MAP_FAILED) {
+            close(Fd);
+            memset(file, 0, sizeof(MappedFile));
+            return PLATFORM_FAIL;
+        }
+        madvise(Data, file->Size, MADV_SEQUENTIAL);
+        madvise(Data, file->Size, MADV_WILLNEED);
+        file->Data = (const char*)Data;
+    }
+
+    // NOTE(Jovan): Mapping stays valid after the descriptor is closed
+    close(Fd);
+    return PLATFORM_SUCCESS;
+}
+
+void
+PlatformUnmapFile(MappedFile* file) {
+    if(file->Data) {
+        munmap((void*)file->Data, file->Size);
+    }
+    memset(file, 0, sizeof(MappedFile));
+}
+
+int
+PlatformFileStat(const char* filePath, uint64_t* size, int64_t* modifiedTime) {
+    struct stat Stat;
+    if(stat(filePath, &Stat) != 0) {
+        return PLATFORM_FAIL;
+    }
+
+    *size = (uint64_t)Stat.st_size;
+    *modifiedTime = (int64_t)Stat.st_mtim.tv_sec * 1000000000 + Stat.st_mtim.tv_nsec;
+    return PLATFORM_SUCCESS;
+}
+
+int
+PlatformReplaceFile(const char* sourcePath, const char* destinationPath) {
+    return rename(sourcePath, destinationPath) == 0 ? PLATFORM_SUCCESS : PLATFORM_FAIL;
+}
+
+void*
+PlatformAllocPages(size_t* size, int largePages) {
+    size_t Rounded = largePages ? (*size + PLATFORM_LARGE_PAGE_SIZE - 1) & ~(size_t)(PLATFORM_LARGE_PAGE_SIZE - 1) : *size;
+    void* Memory = mmap(NULL, Rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(Memory == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    // NOTE(Jovan): Only a hint, transparent huge pages may be disabled system wide
+    if(largePages) {
+        madvise(Memory, Rounded, MADV_HUGEPAGE);
+    }
+#endif
+    *size = Rounded;
+    return Memory;
+}
+
+void
+PlatformFreePages(void* memory, size_t size) {
+    if(memory) {
+        munmap(memory, size);
+    }
+}
+
+uint64_t
+PlatformTimerTicks(void) {
+    struct timespec Now;
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (uint64_t)Now.tv_sec * 1000000000u + (uint64_t)Now.tv_nsec;
+}
+
+uint64_t
+PlatformTimerFrequency(void) {
+    return 1000000000u;
+}
+
+unsigned
+PlatformCpuCount(void) {
+    long Count = sysconf(_SC_NPROCESSORS_ONLN);
+    return Count > 0 ? (unsigned)Count : 1;
+}
+
+static void*
+ThreadEntry(void* arg) {
+    Thread* Self = (Thread*)arg;
+    Self->Func(Self->Arg);
+    return NULL;
+}
+
+Thread*
+ThreadCreate(ThreadFunc func, void* arg) {
+    Thread* Result = (Thread*)calloc(1, sizeof(Thread));
+    if(!Result) {
+        return NULL;
+    }
+
+    Result->Func = func;
+    Result->Arg = arg;
+    if(pthread_create(&Result->Handle, NULL, ThreadEntry, Result) != 0) {
+        free(Result);
+        return NULL;
+    }
+
+    return Result;
+}
+
+void
+ThreadJoin(Thread* thread) {
+    pthread_join(thread->Handle, NULL);
+    free(thread);
+}
+
+Mutex*
+MutexCreate(void) {
+    Mutex* Result = (Mutex*)calloc(1, sizeof(Mutex));
+    if(Result) {
+        pthread_mutex_init(&Result->Lock, NULL);
+    }
+    return Result;
+}
+
+void
+MutexDestroy(Mutex* mutex) {
+    pthread_mutex_destroy(&mutex->Lock);
+    free(mutex);
+}
+
+void
+MutexLock(Mutex* mutex) {
+    pthread_mutex_lock(&mutex->Lock);
+}
+
+void
+MutexUnlock(Mutex* mutex) {
+    pthread_mutex_unlock(&mutex->Lock);
+}
+
+CondVar*
+CondVarCreate(void) {
+    CondVar* Result = (CondVar*)calloc(1, sizeof(CondVar));
+    if(Result) {
+        pthread_cond_init(&Result->Cond, NULL);
+    }
+    return Result;
+}
+
+void
+CondVarDestroy(CondVar* condVar) {
+    pthread_cond_destroy(&condVar->Cond);
+    free(condVar);
+}
+
+void
+CondVarWait(CondVar* condVar, Mutex* mutex) {
+    pthread_cond_wait(&condVar->Cond, &mutex->Lock);
+}
+
+void
+CondVarSignal(CondVar* condVar) {
+    pthread_cond_signal(&condVar->Cond);
+}
+
+void
+CondVarBroadcast(CondVar* condVar) {
+    pthread_cond_broadcast(&condVar->Cond);
+}
+
+long
+AtomicIncrement(volatile long* value) {
+    return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+long
+AtomicDecrement(volatile long* value) {
+    return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+long
+AtomicAdd(volatile long* value, long amount) {
+    return __atomic_add_fetch(value, amount, __ATOMIC_SEQ_CST);
+}
+
+long
+AtomicLoad(volatile long* value) {
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+void
+AtomicStore(volatile long* value, long newValue) {
+    __atomic_store_n(value, newValue, __ATOMIC_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * @file platform.h
+ * @author Jovan Ivosevic
+ * @brief Thin OS abstraction: memory mapped files, page allocation, timers, threads, locks and atomics
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#define PLATFORM_SUCCESS 1
+#define PLATFORM_FAIL 0
+// NOTE(Jovan): Transparent huge page size on x86-64 Linux, Windows queries its own
+#define PLATFORM_LARGE_PAGE_SIZE (2u << 20)
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Read-only view of a whole file mapped into memory
+ *
+ */
+typedef struct MappedFile {
+    const char* Data;
+    size_t Size;
+    // NOTE(Jovan): Taken from the mapped handle, so it describes the contents actually mapped
+    int64_t ModifiedTime;
+    void* FileHandle;
+    void* MappingHandle;
+} MappedFile;
+
+typedef struct Thread Thread;
+typedef struct Mutex Mutex;
+typedef struct CondVar CondVar;
+typedef int (*ThreadFunc)(void* arg);
+
+/**
+ * @brief Maps whole file into memory for reading
+ *
+ * @param filePath File path
+ * @param file Result, filled on success
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int PlatformMapFile(const char* filePath, MappedFile* file);
+
+/**
+ * @brief Unmaps file previously mapped with PlatformMapFile. Safe to call on zeroed struct.
+ *
+ * @param file Mapped file
+ */
+void PlatformUnmapFile(MappedFile* file);
+
+/**
+ * @brief Queries file size and last modification time
+ *
+ * @param filePath File path
+ * @param size Output file size in bytes
+ * @param modifiedTime Output modification time, opaque platform units
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int PlatformFileStat(const char* filePath, uint64_t* size, int64_t* modifiedTime);
+
+/**
+ * @brief Atomically replaces destination file with source file
+ *
+ * @param sourcePath File to be moved
+ * @param destinationPath File to be replaced
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int PlatformReplaceFile(const char* sourcePath, const char* destinationPath);
+
+/**
+ * @brief Allocates zeroed, page aligned memory straight from the OS
+ *
+ * @param size Requested size, rounded up to the page size actually used
+ * @param largePages Nonzero asks for large pages, silently falls back to regular ones
+ * @return void* Memory, NULL on failure. Release with PlatformFreePages.
+ */
+void* PlatformAllocPages(size_t* size, int largePages);
+
+/**
+ * @brief Releases memory returned by PlatformAllocPages
+ *
+ * @param memory Memory, may be NULL
+ * @param size Size reported by PlatformAllocPages
+ */
+void PlatformFreePages(void* memory, size_t size);
+
+/**
+ * @brief Reads monotonic high-resolution timer
+ *
+ * @return uint64_t Ticks since an arbitrary point, PlatformTimerFrequency ticks per second
+ */
+uint64_t PlatformTimerTicks(void);
+uint64_t PlatformTimerFrequency(void);
+
+/**
+ * @brief Returns number of logical processors, at least 1
+ *
+ */
+unsigned PlatformCpuCount(void);
+
+/**
+ * @brief Starts a new thread executing func(arg)
+ *
+ * @param func Thread entry
+ * @param arg Entry argument
+ * @return Thread* Thread handle, NULL on failure
+ */
+Thread* ThreadCreate(ThreadFunc func, void* arg);
+
+/**
+ * @brief Waits for thread to finish and releases its handle
+ *
+ * @param thread Thread handle
+ */
+void ThreadJoin(Thread* thread);
+
+Mutex* MutexCreate(void);
+void MutexDestroy(Mutex* mutex);
+void MutexLock(Mutex* mutex);
+void MutexUnlock(Mutex* mutex);
+
+CondVar* CondVarCreate(void);
+void CondVarDestroy(CondVar* condVar);
+/**
+ * @brief Atomically releases mutex and waits for signal. Mutex is re-acquired on return.
+ *
+ */
+void CondVarWait(CondVar* condVar, Mutex* mutex);
+void CondVarSignal(CondVar* condVar);
+void CondVarBroadcast(CondVar* condVar);
+
+/**
+ * @brief Atomic operations on shared counters. All return the new value.
+ *
+ */
+long AtomicIncrement(volatile long* value);
+long AtomicDecrement(volatile long* value);
+long AtomicAdd(volatile long* value, long amount);
+long AtomicLoad(volatile long* value);
+void AtomicStore(volatile long* value, long newValue);
+
+#endif
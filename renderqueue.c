@@ -0,0 +1,206 @@
+#include "renderqueue.h"
+#include "shader.h"
+#include "glstate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1u << RADIX_BITS)
+
+void
+BeginRenderQueue(RenderQueue* queue, const RenderView* view, float depthRange) {
+    queue->NumPackets = 0;
+    queue->View = view;
+    queue->DepthRange = depthRange;
+}
+
+static uint32_t
+DepthKey(const RenderQueue* queue, unsigned pass, const float* position) {
+    float Distance = glm_vec3_distance((float*)queue->View->CameraPosition, (float*)position);
+    float Normalized = queue->DepthRange > 0.0f ? Distance / queue->DepthRange : 0.0f;
+    Normalized = Normalized < 0.0f ? 0.0f : (Normalized > 1.0f ? 1.0f : Normalized);
+    uint32_t Depth = (uint32_t)(Normalized * (float)RENDER_KEY_DEPTH_MASK);
+    // NOTE(Jovan): Blending needs the far surfaces first, so transparent depth counts down
+    return pass == RENDER_PASS_TRANSPARENT ? RENDER_KEY_DEPTH_MASK - Depth : Depth;
+}
+
+static uint64_t
+PacketKey(unsigned pass, unsigned program, unsigned material, unsigned vao, uint32_t depth) {
+    return (uint64_t)(pass & 0xFu) << RENDER_KEY_PASS_SHIFT
+         | (uint64_t)(program & RENDER_KEY_FIELD_MASK) << RENDER_KEY_PROGRAM_SHIFT
+         | (uint64_t)(material & RENDER_KEY_FIELD_MASK) << RENDER_KEY_MATERIAL_SHIFT
+         | (uint64_t)(vao & RENDER_KEY_FIELD_MASK) << RENDER_KEY_VAO_SHIFT
+         | (uint64_t)(depth & RENDER_KEY_DEPTH_MASK);
+}
+
+static DrawPacket*
+AllocPacket(RenderQueue* queue) {
+    if(queue->NumPackets == queue->Capacity) {
+        unsigned Capacity = queue->Capacity ? 2 * queue->Capacity : 64;
+        DrawPacket* Packets = (DrawPacket*)realloc(queue->Packets, Capacity * sizeof(DrawPacket));
+        if(Packets) {
+            queue->Packets = Packets;
+        }
+        uint64_t* Keys = Packets ? (uint64_t*)realloc(queue->Keys, 2 * Capacity * sizeof(uint64_t)) : NULL;
+        if(Keys) {
+            queue->Keys = Keys;
+        }
+        unsigned* Order = Keys ? (unsigned*)realloc(queue->Order, 2 * Capacity * sizeof(unsigned)) : NULL;
+        if(!Order) {
+            fprintf(stderr, "Failed to allocate render queue.\n");
+            return NULL;
+        }
+        queue->Order = Order;
+        queue->Capacity = Capacity;
+    }
+
+    DrawPacket* Packet = &queue->Packets[queue->NumPackets++];
+    memset(Packet, 0, sizeof(DrawPacket));
+    return Packet;
+}
+
+int
+SubmitArrays(RenderQueue* queue, unsigned pass, unsigned program, unsigned vao, GLenum mode, GLint first,
+             GLsizei count, mat4 modelMatrix) {
+    DrawPacket* Packet = AllocPacket(queue);
+    if(!Packet) {
+        return RENDERQUEUE_FAIL;
+    }
+
+    Packet->Type = RENDER_DRAW_ARRAYS;
+    Packet->Program = program;
+    Packet->VAO = vao;
+    Packet->Mode = mode;
+    Packet->First = first;
+    Packet->Count = count;
+    Packet->ModelMatrix = modelMatrix;
+    Packet->Key = PacketKey(pass, program, 0, vao, DepthKey(queue, pass, modelMatrix[3]));
+    return RENDERQUEUE_SUCCESS;
+}
+
+int
+SubmitInstances(RenderQueue* queue, unsigned pass, unsigned program, InstanceBatch* batch) {
+    if(!batch->NumInstances) {
+        return RENDERQUEUE_SUCCESS;
+    }
+    DrawPacket* Packet = AllocPacket(queue);
+    if(!Packet) {
+        return RENDERQUEUE_FAIL;
+    }
+
+    uint32_t Depth = DepthKey(queue, pass, batch->Instances[0].Model + 12);
+    for(unsigned InstanceIdx = 1; InstanceIdx < batch->NumInstances; ++InstanceIdx) {
+        uint32_t InstanceDepth = DepthKey(queue, pass, batch->Instances[InstanceIdx].Model + 12);
+        Depth = InstanceDepth < Depth ? InstanceDepth : Depth;
+    }
+    Packet->Type = RENDER_DRAW_INSTANCES;
+    Packet->Program = program;
+    Packet->VAO = batch->VAO;
+    Packet->Batch = batch;
+    Packet->Key = PacketKey(pass, program, 0, batch->VAO, Depth);
+    return RENDERQUEUE_SUCCESS;
+}
+
+int
+SubmitModel(RenderQueue* queue, unsigned pass, unsigned program, Model* model, mat4 modelMatrix) {
+    DrawPacket* Packet = AllocPacket(queue);
+    if(!Packet) {
+        return RENDERQUEUE_FAIL;
+    }
+
+    Packet->Type = RENDER_DRAW_MODEL;
+    Packet->Program = program;
+    Packet->VAO = model->VAO;
+    Packet->ModelMatrix = modelMatrix;
+    Packet->Model = model;
+    Packet->Key = PacketKey(pass, program, 0, model->VAO, DepthKey(queue, pass, modelMatrix[3]));
+    return RENDERQUEUE_SUCCESS;
+}
+
+void
+SortRenderQueue(RenderQueue* queue) {
+    unsigned NumPackets = queue->NumPackets;
+    uint64_t* Keys = queue->Keys;
+    uint64_t* Scratch = queue->Keys + queue->Capacity;
+    unsigned* Order = queue->Order;
+    unsigned* OrderScratch = queue->Order + queue->Capacity;
+    for(unsigned PacketIdx = 0; PacketIdx < NumPackets; ++PacketIdx) {
+        Keys[PacketIdx] = queue->Packets[PacketIdx].Key;
+        Order[PacketIdx] = PacketIdx;
+    }
+
+    // NOTE(Jovan): Stable counting sort per byte, lowest byte first. Bytes shared by every key,
+    // e.g. the pass of a scene without transparency, skip their scatter.
+    for(unsigned Shift = 0; Shift < 64; Shift += RADIX_BITS) {
+        unsigned Counts[RADIX_BUCKETS] = { 0 };
+        for(unsigned PacketIdx = 0; PacketIdx < NumPackets; ++PacketIdx) {
+            ++Counts[(Keys[PacketIdx] >> Shift) & (RADIX_BUCKETS - 1)];
+        }
+        if(NumPackets && Counts[(Keys[0] >> Shift) & (RADIX_BUCKETS - 1)] == NumPackets) {
+            continue;
+        }
+
+        unsigned Offset = 0;
+        for(unsigned Bucket = 0; Bucket < RADIX_BUCKETS; ++Bucket) {
+            unsigned Count = Counts[Bucket];
+            Counts[Bucket] = Offset;
+            Offset += Count;
+        }
+        for(unsigned PacketIdx = 0; PacketIdx < NumPackets; ++PacketIdx) {
+            unsigned Dest = Counts[(Keys[PacketIdx] >> Shift) & (RADIX_BUCKETS - 1)]++;
+            Scratch[Dest] = Keys[PacketIdx];
+            OrderScratch[Dest] = Order[PacketIdx];
+        }
+
+        uint64_t* SwapKeys = Keys;
+        Keys = Scratch;
+        Scratch = SwapKeys;
+        unsigned* SwapOrder = Order;
+        Order = OrderScratch;
+        OrderScratch = SwapOrder;
+    }
+
+    // NOTE(Jovan): Odd number of scatters leaves the result in the scratch half
+    if(Keys != queue->Keys) {
+        memcpy(queue->Keys, Keys, NumPackets * sizeof(uint64_t));
+        memcpy(queue->Order, Order, NumPackets * sizeof(unsigned));
+    }
+}
+
+unsigned
+ExecuteRenderQueue(RenderQueue* queue) {
+    SortRenderQueue(queue);
+
+    unsigned CurrProgram = 0;
+    GLint ModelLocation = -1;
+    for(unsigned OrderIdx = 0; OrderIdx < queue->NumPackets; ++OrderIdx) {
+        const DrawPacket* Packet = &queue->Packets[queue->Order[OrderIdx]];
+        if(Packet->Program != CurrProgram) {
+            UseShaderProgram(Packet->Program);
+            ModelLocation = GetUniformLocation(Packet->Program, "uModel");
+            CurrProgram = Packet->Program;
+        }
+
+        if(Packet->Type == RENDER_DRAW_INSTANCES) {
+            DrawInstances(Packet->Batch);
+        } else if(Packet->Type == RENDER_DRAW_MODEL) {
+            glUniformMatrix4fv(ModelLocation, 1, GL_FALSE, (float*)Packet->ModelMatrix);
+            RenderModelCulled(Packet->Model, queue->View, Packet->ModelMatrix);
+        } else {
+            StateBindVertexArray(Packet->VAO);
+            glUniformMatrix4fv(ModelLocation, 1, GL_FALSE, (float*)Packet->ModelMatrix);
+            glDrawArrays(Packet->Mode, Packet->First, Packet->Count);
+        }
+    }
+    return queue->NumPackets;
+}
+
+void
+FreeRenderQueue(RenderQueue* queue) {
+    free(queue->Packets);
+    free(queue->Keys);
+    free(queue->Order);
+    memset(queue, 0, sizeof(RenderQueue));
+}
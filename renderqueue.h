@@ -0,0 +1,140 @@
+/**
+ * @file renderqueue.h
+ * @author Jovan Ivosevic
+ * @brief Per-frame queue of draw packets sorted by 64-bit state and depth keys
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#define RENDERQUEUE_SUCCESS 1
+#define RENDERQUEUE_FAIL 0
+#define RENDER_PASS_OPAQUE 0
+#define RENDER_PASS_TRANSPARENT 1
+#define RENDER_DRAW_ARRAYS 0
+#define RENDER_DRAW_INSTANCES 1
+#define RENDER_DRAW_MODEL 2
+// NOTE(Jovan): Key bits from the top: pass 4, program 12, material 12, VAO 12, depth 24.
+//             Names wider than their field only share a group, packets still bind their own state.
+#define RENDER_KEY_PASS_SHIFT 60
+#define RENDER_KEY_PROGRAM_SHIFT 48
+#define RENDER_KEY_MATERIAL_SHIFT 36
+#define RENDER_KEY_VAO_SHIFT 24
+#define RENDER_KEY_FIELD_MASK 0xFFFu
+#define RENDER_KEY_DEPTH_MASK 0xFFFFFFu
+
+#include <stdint.h>
+#include "model.h"
+#include "instancing.h"
+
+/**
+ * @brief One draw submitted to the queue. Model matrix is referenced, not copied, and has to stay
+ *        valid until the queue is executed. Instanced packets carry their matrices in the batch.
+ *
+ */
+typedef struct DrawPacket {
+    uint64_t Key;
+    unsigned Type;
+    unsigned Program;
+    unsigned VAO;
+    GLenum Mode;
+    GLint First;
+    GLsizei Count;
+    vec4* ModelMatrix;
+    InstanceBatch* Batch;
+    Model* Model;
+} DrawPacket;
+
+/**
+ * @brief Draw packets of one frame. Keys are sorted as key and packet index pairs, packets stay in place.
+ *        Key and order arrays are twice the capacity, the upper half is radix sort scratch.
+ *
+ */
+typedef struct RenderQueue {
+    DrawPacket* Packets;
+    unsigned NumPackets;
+    unsigned Capacity;
+    uint64_t* Keys;
+    unsigned* Order;
+    const RenderView* View;
+    float DepthRange;
+} RenderQueue;
+
+/**
+ * @brief Empties the queue for a new frame
+ *
+ * @param queue Queue, zeroed before the first frame
+ * @param view Camera used for depth keys and model culling, has to stay valid until the queue is executed
+ * @param depthRange Distance mapped to the largest depth key, usually the far plane
+ */
+void BeginRenderQueue(RenderQueue* queue, const RenderView* view, float depthRange);
+
+/**
+ * @brief Queues non-indexed draw of a VAO, uModel is set to model matrix
+ *
+ * @param queue Queue
+ * @param pass RENDER_PASS_*
+ * @param program Program ID
+ * @param vao VAO ID
+ * @param mode Primitive type
+ * @param first First vertex
+ * @param count Number of vertices
+ * @param modelMatrix Model to world transform
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SubmitArrays(RenderQueue* queue, unsigned pass, unsigned program, unsigned vao, GLenum mode, GLint first,
+                 GLsizei count, mat4 modelMatrix);
+
+/**
+ * @brief Queues all instances of a batch as one draw, keyed by its instance closest to the camera
+ *
+ * @param queue Queue
+ * @param pass RENDER_PASS_*
+ * @param program Program ID
+ * @param batch Instance batch
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SubmitInstances(RenderQueue* queue, unsigned pass, unsigned program, InstanceBatch* batch);
+
+/**
+ * @brief Queues culled model draw. Materials vary inside the model, so the key carries only its VAO.
+ *
+ * @param queue Queue
+ * @param pass RENDER_PASS_*
+ * @param program Program ID
+ * @param model Model
+ * @param modelMatrix Model to world transform
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SubmitModel(RenderQueue* queue, unsigned pass, unsigned program, Model* model, mat4 modelMatrix);
+
+/**
+ * @brief Sorts queued packets by key with a least significant digit radix sort. Opaque packets
+ *        of the same state run front to back, transparent ones back to front.
+ *
+ * @param queue Queue
+ */
+void SortRenderQueue(RenderQueue* queue);
+
+/**
+ * @brief Sorts and draws queued packets. Program and VAO binds go through the state cache,
+ *        so runs of packets sharing them bind once.
+ *
+ * @param queue Queue
+ * @return unsigned Number of packets drawn
+ */
+unsigned ExecuteRenderQueue(RenderQueue* queue);
+
+/**
+ * @brief Frees queue memory. Does not free queue struct itself.
+ *
+ * @param queue Queue
+ */
+void FreeRenderQueue(RenderQueue* queue);
+
+#endif
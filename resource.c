@@ -0,0 +1,352 @@
+#include "resource.h"
+#include "shader.h"
+#include "hash.h"
+#include "vfs.h"
+#include "jobs.h"
+
+#include <string.h>
+
+struct ModelResource {
+    char* FilePath;
+    // NOTE(Jovan): Hashed only once another file has to be compared against it
+    int Hashed;
+    uint64_t ContentHash;
+    uint64_t ContentSize;
+    int References;
+    int State;
+    // NOTE(Jovan): Initial load or reload in flight, NULL otherwise
+    ModelLoad* Load;
+    // NOTE(Jovan): File changed while Load was running, reload starts once it ends
+    int ReloadPending;
+    Model Model;
+    struct ModelResource* Next;
+};
+
+struct ShaderResource {
+    char* VertexShaderPath;
+    char* FragmentShaderPath;
+    int Hashed;
+    uint64_t ContentHash;
+    int References;
+    int State;
+    // NOTE(Jovan): Sources changed while the first build was pending, rebuilt once it is done
+    int ReloadPending;
+    unsigned Program;
+    struct ShaderResource* Next;
+};
+
+static ModelResource* sModels;
+static ShaderResource* sShaders;
+
+static char*
+CopyString(const char* value) {
+    size_t Length = strlen(value) + 1;
+    char* Result = (char*)malloc(Length);
+    if(Result) {
+        memcpy(Result, value, Length);
+    }
+    return Result;
+}
+
+static int
+HashFile(const char* filePath, uint64_t seed, uint64_t* hash, uint64_t* size) {
+    VfsFile File;
+    if(!VfsOpenFile(filePath, &File)) {
+        return RESOURCE_FAIL;
+    }
+
+    *hash = HashBytes(File.Data, File.Size, seed);
+    *size = File.Size;
+    VfsCloseFile(&File);
+    return RESOURCE_SUCCESS;
+}
+
+static int
+HashModelResource(ModelResource* resource) {
+    if(!resource->Hashed) {
+        resource->Hashed = HashFile(resource->FilePath, 0, &resource->ContentHash, &resource->ContentSize);
+    }
+    return resource->Hashed;
+}
+
+static int
+HashShaderResource(ShaderResource* resource) {
+    uint64_t Size;
+    if(!resource->Hashed) {
+        resource->Hashed = HashFile(resource->VertexShaderPath, 0, &resource->ContentHash, &Size)
+                           && HashFile(resource->FragmentShaderPath, resource->ContentHash, &resource->ContentHash, &Size);
+    }
+    return resource->Hashed;
+}
+
+static void
+FreeModelResource(ModelResource* resource) {
+    ModelResource** Link = &sModels;
+    while(*Link != resource) {
+        Link = &(*Link)->Next;
+    }
+    *Link = resource->Next;
+
+    FreeModelResources(&resource->Model);
+    free(resource->FilePath);
+    free(resource);
+}
+
+ModelResource*
+AcquireModel(const char* filePath) {
+    for(ModelResource* Curr = sModels; Curr; Curr = Curr->Next) {
+        if(!strcmp(Curr->FilePath, filePath)) {
+            ++Curr->References;
+            return Curr;
+        }
+    }
+
+    // NOTE(Jovan): Only misses by path with other models around pay for hashing, so the first load
+    //             of a file starts without reading it on this thread
+    uint64_t ContentHash = 0, ContentSize = 0;
+    int Hashed = sModels && HashFile(filePath, 0, &ContentHash, &ContentSize);
+    for(ModelResource* Curr = sModels; Hashed && Curr; Curr = Curr->Next) {
+        if(Curr->State != MODEL_LOAD_FAILED && HashModelResource(Curr) && Curr->ContentHash == ContentHash
+           && Curr->ContentSize == ContentSize) {
+            ++Curr->References;
+            return Curr;
+        }
+    }
+
+    ModelResource* Result = (ModelResource*)calloc(1, sizeof(ModelResource));
+    if(!Result || !(Result->FilePath = CopyString(filePath))) {
+        fprintf(stderr, "Failed to allocate model resource %s.\n", filePath);
+        free(Result);
+        return NULL;
+    }
+
+    Result->Load = LoadModelAsync(filePath, &Result->Model);
+    if(!Result->Load) {
+        free(Result->FilePath);
+        free(Result);
+        return NULL;
+    }
+
+    Result->Hashed = Hashed;
+    Result->ContentHash = ContentHash;
+    Result->ContentSize = ContentSize;
+    Result->References = 1;
+    Result->State = MODEL_LOAD_PENDING;
+    Result->Next = sModels;
+    sModels = Result;
+    return Result;
+}
+
+Model*
+GetModel(const ModelResource* resource) {
+    return (Model*)&resource->Model;
+}
+
+int
+GetModelResourceState(const ModelResource* resource) {
+    return resource->State;
+}
+
+int
+ReloadModelResource(ModelResource* resource) {
+    // NOTE(Jovan): Running load may have read the file before the change, so the change isn't dropped
+    if(resource->Load) {
+        fprintf(stdout, "%s is still loading, reload queued.\n", resource->FilePath);
+        resource->ReloadPending = 1;
+        return RESOURCE_SUCCESS;
+    }
+
+    resource->Load = ReloadModelAsync(resource->FilePath, &resource->Model);
+    if(!resource->Load) {
+        return RESOURCE_FAIL;
+    }
+
+    // NOTE(Jovan): Content changed, copies of the old content must not be matched against it anymore
+    resource->Hashed = 0;
+    return RESOURCE_SUCCESS;
+}
+
+void
+ReleaseModel(ModelResource* resource) {
+    if(!resource || --resource->References) {
+        return;
+    }
+
+    // NOTE(Jovan): Load still writes into the model, ProcessResources frees it once the load ends
+    if(!resource->Load) {
+        FreeModelResource(resource);
+    }
+}
+
+typedef struct ShaderBuild {
+    // NOTE(Jovan): Queue node for the hand-over to the main thread, compiling must never fall back to a worker
+    Job MainJob;
+    ShaderResource* Resource;
+    VfsFile VertexSource;
+    VfsFile FragmentSource;
+    int Read;
+} ShaderBuild;
+
+static void FreeShaderResource(ShaderResource* resource);
+
+static void
+BuildShaderJob(void* data) {
+    ShaderBuild* Build = (ShaderBuild*)data;
+    ShaderResource* Resource = Build->Resource;
+    if(Build->Read) {
+        Resource->Program = CreateShaderFromSources(&Build->VertexSource, &Build->FragmentSource,
+                                                    Resource->VertexShaderPath, Resource->FragmentShaderPath);
+    } else {
+        fprintf(stderr, "ERROR: failed to read %s or %s.\n", Resource->VertexShaderPath, Resource->FragmentShaderPath);
+    }
+    Resource->State = Resource->Program ? RESOURCE_READY : RESOURCE_FAILED;
+
+    VfsCloseFile(&Build->VertexSource);
+    VfsCloseFile(&Build->FragmentSource);
+    free(Build);
+    if(!Resource->References) {
+        FreeShaderResource(Resource);
+    } else if(Resource->ReloadPending) {
+        Resource->ReloadPending = 0;
+        ReloadShaderResource(Resource);
+    }
+}
+
+static void
+ReadShaderJob(void* data) {
+    ShaderBuild* Build = (ShaderBuild*)data;
+    Build->Read = VfsOpenFile(Build->Resource->VertexShaderPath, &Build->VertexSource)
+                  && VfsOpenFile(Build->Resource->FragmentShaderPath, &Build->FragmentSource);
+    JobSubmitMain(&Build->MainJob, BuildShaderJob, Build);
+}
+
+ShaderResource*
+AcquireShader(const char* vertexShaderPath, const char* fragmentShaderPath) {
+    for(ShaderResource* Curr = sShaders; Curr; Curr = Curr->Next) {
+        if(!strcmp(Curr->VertexShaderPath, vertexShaderPath) && !strcmp(Curr->FragmentShaderPath, fragmentShaderPath)) {
+            ++Curr->References;
+            return Curr;
+        }
+    }
+
+    uint64_t ContentHash = 0, VertexSize, FragmentSize;
+    int Hashed = sShaders && HashFile(vertexShaderPath, 0, &ContentHash, &VertexSize)
+                 && HashFile(fragmentShaderPath, ContentHash, &ContentHash, &FragmentSize);
+    for(ShaderResource* Curr = sShaders; Hashed && Curr; Curr = Curr->Next) {
+        if(Curr->State != RESOURCE_FAILED && HashShaderResource(Curr) && Curr->ContentHash == ContentHash) {
+            ++Curr->References;
+            return Curr;
+        }
+    }
+
+    ShaderResource* Result = (ShaderResource*)calloc(1, sizeof(ShaderResource));
+    ShaderBuild* Build = (ShaderBuild*)calloc(1, sizeof(ShaderBuild));
+    if(!Result || !Build || !(Result->VertexShaderPath = CopyString(vertexShaderPath))
+       || !(Result->FragmentShaderPath = CopyString(fragmentShaderPath))) {
+        fprintf(stderr, "Failed to allocate shader resource %s.\n", vertexShaderPath);
+        if(Result) {
+            free(Result->VertexShaderPath);
+        }
+        free(Result);
+        free(Build);
+        return NULL;
+    }
+
+    Result->Hashed = Hashed;
+    Result->ContentHash = ContentHash;
+    Result->References = 1;
+    Result->State = RESOURCE_PENDING;
+    Result->Next = sShaders;
+    sShaders = Result;
+
+    // NOTE(Jovan): Sources are read on a worker, compiling needs the GL context and comes back to this thread
+    Build->Resource = Result;
+    JobSubmit(ReadShaderJob, Build);
+    return Result;
+}
+
+unsigned
+GetShaderProgram(const ShaderResource* resource) {
+    return resource->Program;
+}
+
+int
+GetShaderResourceState(const ShaderResource* resource) {
+    return resource->State;
+}
+
+int
+ReloadShaderResource(ShaderResource* resource) {
+    if(resource->State == RESOURCE_PENDING) {
+        fprintf(stdout, "%s is still building, reload queued.\n", resource->VertexShaderPath);
+        resource->ReloadPending = 1;
+        return RESOURCE_SUCCESS;
+    }
+    if(!ReloadShader(&resource->Program, resource->VertexShaderPath, resource->FragmentShaderPath)) {
+        return RESOURCE_FAIL;
+    }
+
+    resource->State = RESOURCE_READY;
+    resource->Hashed = 0;
+    return RESOURCE_SUCCESS;
+}
+
+static void
+FreeShaderResource(ShaderResource* resource) {
+    ShaderResource** Link = &sShaders;
+    while(*Link != resource) {
+        Link = &(*Link)->Next;
+    }
+    *Link = resource->Next;
+
+    DeleteShaderProgram(resource->Program);
+    free(resource->VertexShaderPath);
+    free(resource->FragmentShaderPath);
+    free(resource);
+}
+
+void
+ReleaseShader(ShaderResource* resource) {
+    // NOTE(Jovan): Pending build still writes into the resource, it frees the resource itself
+    if(resource && !--resource->References && resource->State != RESOURCE_PENDING) {
+        FreeShaderResource(resource);
+    }
+}
+
+void
+ProcessResources(void) {
+    JobRunMain(0);
+    ProcessModelLoads();
+    ModelResource* Curr = sModels;
+    while(Curr) {
+        ModelResource* Next = Curr->Next;
+        int LoadState = Curr->Load ? GetModelLoadState(Curr->Load) : MODEL_LOAD_PENDING;
+        if(Curr->Load && LoadState != MODEL_LOAD_PENDING) {
+            // NOTE(Jovan): Failed reload leaves the previous version, which is still ready
+            if(Curr->State == MODEL_LOAD_PENDING) {
+                Curr->State = LoadState;
+            }
+            ReleaseModelLoad(Curr->Load);
+            Curr->Load = NULL;
+            if(!Curr->References) {
+                FreeModelResource(Curr);
+            } else if(Curr->ReloadPending) {
+                Curr->ReloadPending = 0;
+                ReloadModelResource(Curr);
+            }
+        }
+        Curr = Next;
+    }
+}
+
+void
+ShutdownResources(void) {
+    while(sModels) {
+        ReleaseModelLoad(sModels->Load);
+        sModels->Load = NULL;
+        FreeModelResource(sModels);
+    }
+    while(sShaders) {
+        FreeShaderResource(sShaders);
+    }
+}
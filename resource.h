@@ -0,0 +1,119 @@
+/**
+ * @file resource.h
+ * @author Jovan Ivosevic
+ * @brief Reference counted models and shader programs shared by path and content
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef RESOURCE_H
+#define RESOURCE_H
+
+#define RESOURCE_SUCCESS 1
+#define RESOURCE_FAIL 0
+#define RESOURCE_FAILED -1
+#define RESOURCE_PENDING 0
+#define RESOURCE_READY 1
+
+#include "model.h"
+#include "asyncload.h"
+
+typedef struct ModelResource ModelResource;
+typedef struct ShaderResource ShaderResource;
+
+/**
+ * @brief Returns shared model loaded from file, starting a background load on first use. Files are matched
+ *        by path and then by content hash, so copies of one asset under different names share buffers.
+ *        Resources are owned by the render thread, acquire and release them only there.
+ *
+ * @param filePath Relative model file path
+ * @return ModelResource* Handle holding one reference, release with ReleaseModel. NULL on failure.
+ */
+ModelResource* AcquireModel(const char* filePath);
+
+/**
+ * @brief Returns model of the resource. Pointer stays valid until the last reference is released,
+ *        the model gains meshes while it loads and is swapped in place when reloaded.
+ *
+ */
+Model* GetModel(const ModelResource* resource);
+
+/**
+ * @brief Returns state of the first load. Reloads keep the resource ready and replace the model when done.
+ *
+ * @return int MODEL_LOAD_PENDING, MODEL_LOAD_READY or MODEL_LOAD_FAILED
+ */
+int GetModelResourceState(const ModelResource* resource);
+
+/**
+ * @brief Starts reloading model from its file. While a load of it is still running the reload is queued
+ *        and started by ProcessResources once that load ends.
+ *
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ReloadModelResource(ModelResource* resource);
+
+/**
+ * @brief Drops one reference. Last one frees the GPU buffers right away, or as soon as a running load finishes.
+ *
+ * @param resource Handle, may be NULL
+ */
+void ReleaseModel(ModelResource* resource);
+
+/**
+ * @brief Returns shared program built from the two sources, matched by paths and then by content hash.
+ *        Sources of a new program are read on a worker and compiled once ProcessResources or
+ *        JobRunMain picks the build up, until then the program ID is 0.
+ *
+ * @param vertexShaderPath Vertex shader source file path
+ * @param fragmentShaderPath Fragment shader source file path
+ * @return ShaderResource* Handle holding one reference, release with ReleaseShader. NULL on failure.
+ */
+ShaderResource* AcquireShader(const char* vertexShaderPath, const char* fragmentShaderPath);
+
+/**
+ * @brief Returns current program ID, it changes when the program is reloaded
+ *
+ */
+unsigned GetShaderProgram(const ShaderResource* resource);
+
+/**
+ * @brief Returns build state of the program
+ *
+ * @return int RESOURCE_PENDING, RESOURCE_READY or RESOURCE_FAILED
+ */
+int GetShaderResourceState(const ShaderResource* resource);
+
+/**
+ * @brief Rebuilds program from its sources, previous program stays on failure. While the first build
+ *        is still pending the rebuild is queued and runs right after it.
+ *
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ReloadShaderResource(ShaderResource* resource);
+
+/**
+ * @brief Drops one reference, last one deletes the program
+ *
+ * @param resource Handle, may be NULL
+ */
+void ReleaseShader(ShaderResource* resource);
+
+/**
+ * @brief Runs GL work handed over by jobs, publishes finished loads through ProcessModelLoads and
+ *        frees released models whose load just ended. Call once per frame on the render thread.
+ *
+ */
+void ProcessResources(void);
+
+/**
+ * @brief Frees every resource still held. Call after ShutdownAsyncLoader and JobSystemShutdown, so no
+ *        load or build writes into resources anymore. Handles become invalid.
+ *
+ */
+void ShutdownResources(void);
+
+#endif
@@ -0,0 +1,350 @@
+#include "shader.h"
+#include "vfs.h"
+#include "hash.h"
+#include "model.h"
+#include "glstate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SHADER_MAX_NAME 256
+
+/**
+ * @brief Slot of the uniform table, empty slots have location -1
+ *
+ */
+typedef struct ShaderUniform {
+    uint64_t Hash;
+    GLint Location;
+} ShaderUniform;
+
+/**
+ * @brief Reflection of one linked program. Uniform table is open addressed with a power of two slot count.
+ *
+ */
+typedef struct ShaderProgram {
+    unsigned Program;
+    unsigned NumSlots;
+    ShaderUniform* Uniforms;
+} ShaderProgram;
+
+typedef struct BlockBinding {
+    const char* Name;
+    GLuint Binding;
+} BlockBinding;
+
+static const BlockBinding sBlockBindings[] = {
+    { "Materials", MATERIAL_BINDING },
+    { "Camera", CAMERA_BINDING },
+};
+
+// NOTE(Jovan): Only a handful of programs exist, the current one is checked first and the rest scanned
+static ShaderProgram* sPrograms;
+static unsigned sNumPrograms;
+static unsigned sCapacity;
+static unsigned sCurrentProgram;
+static ShaderProgram* sCurrent;
+static unsigned sCameraUBO;
+
+static uint64_t
+UniformNameHash(const char* name, size_t length) {
+    return HashBytes(name, length, 0);
+}
+
+static ShaderProgram*
+FindProgram(unsigned program) {
+    if(sCurrent && sCurrent->Program == program) {
+        return sCurrent;
+    }
+    for(unsigned ProgramIdx = 0; ProgramIdx < sNumPrograms; ++ProgramIdx) {
+        if(sPrograms[ProgramIdx].Program == program) {
+            return &sPrograms[ProgramIdx];
+        }
+    }
+    return NULL;
+}
+
+static void
+InsertUniform(ShaderProgram* program, uint64_t hash, GLint location) {
+    unsigned Mask = program->NumSlots - 1;
+    unsigned Slot = (unsigned)hash & Mask;
+    while(program->Uniforms[Slot].Location != -1 && program->Uniforms[Slot].Hash != hash) {
+        Slot = (Slot + 1) & Mask;
+    }
+    program->Uniforms[Slot].Hash = hash;
+    program->Uniforms[Slot].Location = location;
+}
+
+static void
+BindUniformBlocks(unsigned program) {
+    GLint NumBlocks = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &NumBlocks);
+    for(GLint BlockIdx = 0; BlockIdx < NumBlocks; ++BlockIdx) {
+        char Name[SHADER_MAX_NAME];
+        glGetActiveUniformBlockName(program, (GLuint)BlockIdx, sizeof(Name), NULL, Name);
+        for(unsigned BindingIdx = 0; BindingIdx < sizeof(sBlockBindings) / sizeof(sBlockBindings[0]); ++BindingIdx) {
+            if(!strcmp(Name, sBlockBindings[BindingIdx].Name)) {
+                glUniformBlockBinding(program, (GLuint)BlockIdx, sBlockBindings[BindingIdx].Binding);
+            }
+        }
+    }
+}
+
+static int
+ReflectProgram(unsigned program) {
+    if(sNumPrograms == sCapacity) {
+        unsigned Capacity = sCapacity ? 2 * sCapacity : 8;
+        ShaderProgram* Programs = (ShaderProgram*)realloc(sPrograms, Capacity * sizeof(ShaderProgram));
+        if(!Programs) {
+            fprintf(stderr, "Failed to allocate shader program table.\n");
+            return SHADER_FAIL;
+        }
+        sPrograms = Programs;
+        sCapacity = Capacity;
+        sCurrent = FindProgram(sCurrentProgram);
+    }
+
+    GLint NumUniforms = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &NumUniforms);
+    // NOTE(Jovan): Table is kept at most half full so probes stay short
+    unsigned NumSlots = 8;
+    while(NumSlots < 2 * (unsigned)NumUniforms) {
+        NumSlots *= 2;
+    }
+    ShaderProgram* Reflected = &sPrograms[sNumPrograms];
+    Reflected->Program = program;
+    Reflected->NumSlots = NumSlots;
+    Reflected->Uniforms = (ShaderUniform*)malloc(NumSlots * sizeof(ShaderUniform));
+    if(!Reflected->Uniforms) {
+        fprintf(stderr, "Failed to allocate uniform table.\n");
+        return SHADER_FAIL;
+    }
+    for(unsigned Slot = 0; Slot < NumSlots; ++Slot) {
+        Reflected->Uniforms[Slot].Hash = 0;
+        Reflected->Uniforms[Slot].Location = -1;
+    }
+
+    for(GLint UniformIdx = 0; UniformIdx < NumUniforms; ++UniformIdx) {
+        char Name[SHADER_MAX_NAME];
+        GLsizei Length = 0;
+        GLint Size;
+        GLenum Type;
+        glGetActiveUniform(program, (GLuint)UniformIdx, sizeof(Name), &Length, &Size, &Type, Name);
+        // NOTE(Jovan): Block members have no location and are skipped, arrays are reported as "name[0]"
+        GLint Location = glGetUniformLocation(program, Name);
+        if(Location == -1) {
+            continue;
+        }
+        if(Length > 3 && !strcmp(Name + Length - 3, "[0]")) {
+            Length -= 3;
+        }
+        InsertUniform(Reflected, UniformNameHash(Name, (size_t)Length), Location);
+    }
+
+    BindUniformBlocks(program);
+    ++sNumPrograms;
+    return SHADER_SUCCESS;
+}
+
+static unsigned
+CompileShaderSource(GLenum type, const VfsFile* source, const char* filePath) {
+    // NOTE(Jovan): Source is passed with its length, views into the pack aren't null terminated
+    const char* SourceCode = source->Data;
+    GLint SourceLength = (GLint)source->Size;
+    unsigned Id = glCreateShader(type);
+    glShaderSource(Id, 1, &SourceCode, &SourceLength);
+    glCompileShader(Id);
+
+    GLint Result;
+    glGetShaderiv(Id, GL_COMPILE_STATUS, &Result);
+    if(Result == GL_FALSE) {
+        GLint LogLength = 0;
+        glGetShaderiv(Id, GL_INFO_LOG_LENGTH, &LogLength);
+        char* ErrorMessage = (char*)calloc(LogLength + 1, sizeof(char));
+        if(ErrorMessage) {
+            glGetShaderInfoLog(Id, LogLength, NULL, ErrorMessage);
+        }
+        fprintf(stderr, "ERROR compiling shader %s: %s\n", filePath, ErrorMessage ? ErrorMessage : "");
+        free(ErrorMessage);
+        glDeleteShader(Id);
+        return 0;
+    }
+
+    return Id;
+}
+
+unsigned
+CompileShader(GLenum type, const char* filePath) {
+    VfsFile Source;
+    if(!VfsOpenFile(filePath, &Source)) {
+        fprintf(stderr, "ERROR: %s file not found.\n", filePath);
+        return 0;
+    }
+
+    unsigned Id = CompileShaderSource(type, &Source, filePath);
+    VfsCloseFile(&Source);
+    return Id;
+}
+
+unsigned
+CreateShaderFromSources(const VfsFile* vertexSource, const VfsFile* fragmentSource, const char* vertexShaderPath,
+                        const char* fragmentShaderPath) {
+    unsigned VertexShader = CompileShaderSource(GL_VERTEX_SHADER, vertexSource, vertexShaderPath);
+    unsigned FragmentShader = CompileShaderSource(GL_FRAGMENT_SHADER, fragmentSource, fragmentShaderPath);
+    if(!VertexShader || !FragmentShader) {
+        glDeleteShader(VertexShader);
+        glDeleteShader(FragmentShader);
+        return 0;
+    }
+
+    unsigned Program = glCreateProgram();
+    glAttachShader(Program, VertexShader);
+    glAttachShader(Program, FragmentShader);
+    glLinkProgram(Program);
+    glValidateProgram(Program);
+
+    glDeleteShader(VertexShader);
+    glDeleteShader(FragmentShader);
+
+    GLint Result;
+    glGetProgramiv(Program, GL_LINK_STATUS, &Result);
+    if(Result == GL_FALSE) {
+        GLint LogLength = 0;
+        glGetProgramiv(Program, GL_INFO_LOG_LENGTH, &LogLength);
+        char* ErrorMessage = (char*)calloc(LogLength + 1, sizeof(char));
+        if(ErrorMessage) {
+            glGetProgramInfoLog(Program, LogLength, NULL, ErrorMessage);
+        }
+        fprintf(stderr, "ERROR linking %s and %s: %s\n", vertexShaderPath, fragmentShaderPath,
+                ErrorMessage ? ErrorMessage : "");
+        free(ErrorMessage);
+        glDeleteProgram(Program);
+        return 0;
+    }
+
+    if(!ReflectProgram(Program)) {
+        glDeleteProgram(Program);
+        return 0;
+    }
+
+    return Program;
+}
+
+unsigned
+CreateShader(const char* vertexShaderPath, const char* fragmentShaderPath) {
+    VfsFile VertexSource, FragmentSource;
+    int VertexRead = VfsOpenFile(vertexShaderPath, &VertexSource);
+    int FragmentRead = VfsOpenFile(fragmentShaderPath, &FragmentSource);
+    unsigned Program = 0;
+    if(!VertexRead || !FragmentRead) {
+        fprintf(stderr, "ERROR: %s file not found.\n", VertexRead ? fragmentShaderPath : vertexShaderPath);
+    } else {
+        Program = CreateShaderFromSources(&VertexSource, &FragmentSource, vertexShaderPath, fragmentShaderPath);
+    }
+
+    VfsCloseFile(&VertexSource);
+    VfsCloseFile(&FragmentSource);
+    return Program;
+}
+
+int
+ReloadShader(unsigned* program, const char* vertexShaderPath, const char* fragmentShaderPath) {
+    unsigned Program = CreateShader(vertexShaderPath, fragmentShaderPath);
+    if(!Program) {
+        fprintf(stderr, "Keeping previous version of %s and %s.\n", vertexShaderPath, fragmentShaderPath);
+        return SHADER_FAIL;
+    }
+
+    DeleteShaderProgram(*program);
+    *program = Program;
+    return SHADER_SUCCESS;
+}
+
+void
+DeleteShaderProgram(unsigned program) {
+    if(!program) {
+        return;
+    }
+
+    ShaderProgram* Reflected = FindProgram(program);
+    if(Reflected) {
+        free(Reflected->Uniforms);
+        *Reflected = sPrograms[--sNumPrograms];
+    }
+    if(!sNumPrograms) {
+        free(sPrograms);
+        sPrograms = NULL;
+        sCapacity = 0;
+    }
+    if(sCurrentProgram == program) {
+        sCurrentProgram = 0;
+    }
+    sCurrent = NULL;
+    sCurrent = FindProgram(sCurrentProgram);
+    StateDeleteProgram(program);
+}
+
+void
+UseShaderProgram(unsigned program) {
+    StateUseProgram(program);
+    sCurrentProgram = program;
+    sCurrent = FindProgram(program);
+}
+
+unsigned
+GetCurrentShaderProgram(void) {
+    return sCurrentProgram;
+}
+
+GLint
+GetUniformLocation(unsigned program, const char* name) {
+    const ShaderProgram* Reflected = FindProgram(program);
+    if(!Reflected) {
+        return -1;
+    }
+
+    uint64_t Hash = UniformNameHash(name, strlen(name));
+    unsigned Mask = Reflected->NumSlots - 1;
+    for(unsigned Slot = (unsigned)Hash & Mask;; Slot = (Slot + 1) & Mask) {
+        const ShaderUniform* Uniform = &Reflected->Uniforms[Slot];
+        if(Uniform->Location == -1) {
+            return -1;
+        }
+        if(Uniform->Hash == Hash) {
+            return Uniform->Location;
+        }
+    }
+}
+
+int
+InitCameraBlock(void) {
+    glGenBuffers(1, &sCameraUBO);
+    if(!sCameraUBO) {
+        fprintf(stderr, "Failed to create camera uniform buffer.\n");
+        return SHADER_FAIL;
+    }
+
+    StateBindBuffer(GL_UNIFORM_BUFFER, sCameraUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+    // NOTE(Jovan): Nothing else uses this binding point, so it stays bound for every program and frame
+    StateBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, sCameraUBO);
+    return SHADER_SUCCESS;
+}
+
+void
+UpdateCameraBlock(mat4 view, mat4 projection) {
+    CameraBlock Camera;
+    memcpy(Camera.View, view, sizeof(Camera.View));
+    memcpy(Camera.Projection, projection, sizeof(Camera.Projection));
+    StateBindBuffer(GL_UNIFORM_BUFFER, sCameraUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &Camera);
+}
+
+void
+FreeCameraBlock(void) {
+    if(sCameraUBO) {
+        StateDeleteBuffers(1, &sCameraUBO);
+        sCameraUBO = 0;
+    }
+}
@@ -0,0 +1,127 @@
+/**
+ * @file shader.h
+ * @author Jovan Ivosevic
+ * @brief GLSL shader compilation and program linking from VFS files
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SHADER_H
+#define SHADER_H
+
+#define SHADER_SUCCESS 1
+#define SHADER_FAIL 0
+// NOTE(Jovan): Uniform blocks are bound to these points once at link time, by block name
+#define CAMERA_BINDING 1
+
+#include <GL/glew.h>
+#include "vfs.h"
+#include "cglm/cglm.h"
+
+/**
+ * @brief Contents of the Camera uniform block in std140 layout, shared by every program
+ *
+ */
+typedef struct CameraBlock {
+    float View[16];
+    float Projection[16];
+} CameraBlock;
+
+/**
+ * @brief Compiles GLSL shader, errors are printed with the file path
+ *
+ * @param type Type of shader: GL_VERTEX_SHADER, GL_FRAGMENT_SHADER
+ * @param filePath Shader source file path
+ * @return unsigned Shader ID, 0 on failure
+ */
+unsigned CompileShader(GLenum type, const char* filePath);
+
+/**
+ * @brief Creates GLSL shader program
+ *
+ * @param vertexShaderPath Vertex shader source file path
+ * @param fragmentShaderPath Fragment shader source file path
+ * @return unsigned Program ID, 0 on failure
+ */
+unsigned CreateShader(const char* vertexShaderPath, const char* fragmentShaderPath);
+
+/**
+ * @brief Creates GLSL shader program from sources already in memory, e.g. read on a worker thread.
+ *        Active uniforms are reflected into a hashed table of the program and the Camera and
+ *        Materials blocks are bound to their binding points.
+ *
+ * @param vertexSource Vertex shader source
+ * @param fragmentSource Fragment shader source
+ * @param vertexShaderPath Vertex shader path, used in error messages
+ * @param fragmentShaderPath Fragment shader path, used in error messages
+ * @return unsigned Program ID, 0 on failure
+ */
+unsigned CreateShaderFromSources(const VfsFile* vertexSource, const VfsFile* fragmentSource, const char* vertexShaderPath,
+                                 const char* fragmentShaderPath);
+
+/**
+ * @brief Rebuilds program from its sources and swaps it in. Program is left untouched when
+ *        compilation or linking fails, so the last working version stays in use.
+ *
+ * @param program Program ID, replaced on success
+ * @param vertexShaderPath Vertex shader source file path
+ * @param fragmentShaderPath Fragment shader source file path
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ReloadShader(unsigned* program, const char* vertexShaderPath, const char* fragmentShaderPath);
+
+/**
+ * @brief Deletes program created by this module together with its uniform table
+ *
+ * @param program Program ID, 0 is ignored
+ */
+void DeleteShaderProgram(unsigned program);
+
+/**
+ * @brief Makes program current. Remembered, so draw code can look up uniforms without querying GL.
+ *
+ * @param program Program ID
+ */
+void UseShaderProgram(unsigned program);
+
+/**
+ * @brief Returns program last passed to UseShaderProgram
+ *
+ */
+unsigned GetCurrentShaderProgram(void);
+
+/**
+ * @brief Looks up uniform location in the table reflected at link time, without a driver call.
+ *        Arrays are found by their plain name, members of uniform blocks are not listed.
+ *
+ * @param program Program ID
+ * @param name Uniform name
+ * @return GLint Location, -1 for unknown programs and uniforms, which glUniform silently ignores
+ */
+GLint GetUniformLocation(unsigned program, const char* name);
+
+/**
+ * @brief Creates Camera uniform buffer and binds it to CAMERA_BINDING for good
+ *
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int InitCameraBlock(void);
+
+/**
+ * @brief Uploads view and projection to the Camera block, seen by every program at once
+ *
+ * @param view View matrix
+ * @param projection Projection matrix
+ */
+void UpdateCameraBlock(mat4 view, mat4 projection);
+
+/**
+ * @brief Frees Camera uniform buffer
+ *
+ */
+void FreeCameraBlock(void);
+
+#endif
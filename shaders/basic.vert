@@ -2,15 +2,54 @@
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aCol;
+// Smooth normal and tangent with handedness in w, zero for geometry without them
+layout (location = 2) in vec3 aNormal;
+layout (location = 3) in vec4 aTangent;
+// Per-instance model matrix and color tint, only read by instanced draws
+layout (location = 4) in mat4 aInstanceModel;
+layout (location = 8) in vec4 aInstanceColor;
+
+// Must match MAX_MATERIALS in model.h
+#define MAX_MATERIALS 256
+
+struct Material
+{
+    vec4 Diffuse;
+};
+
+layout (std140) uniform Materials
+{
+    Material uMaterials[MAX_MATERIALS];
+};
+
+// Shared by all programs, written once per frame. Must match CameraBlock in shader.h
+layout (std140) uniform Camera
+{
+    mat4 uView;
+    mat4 uProjection;
+};
 
-uniform mat4 uProjection;
-uniform mat4 uView;
 uniform mat4 uModel;
+// Dequantization of compact vertex formats, identity for float vertices
+uniform vec3 uPosScale = vec3(1.0f);
+uniform vec3 uPosOffset = vec3(0.0f);
+// Index into the material table, negative for geometry with vertex colors
+uniform int uMaterial = -1;
+// Nonzero while drawing instances, model matrix then comes from the instance attributes
+uniform int uInstanced = 0;
 
 out vec3 vCol;
+out vec3 vNormal;
+out vec4 vTangent;
 
 void main()
 {
-    gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0f);
-    vCol = aCol;
+    mat4 Model = uInstanced != 0 ? aInstanceModel : uModel;
+    gl_Position = uProjection * uView * Model * vec4(aPos * uPosScale + uPosOffset, 1.0f);
+    vCol = uMaterial >= 0 ? uMaterials[uMaterial].Diffuse.rgb : aCol;
+    vCol *= uInstanced != 0 ? aInstanceColor.rgb : vec3(1.0f);
+    // Tangents lie in the surface and follow the model matrix, normals need its inverse transpose under non-uniform scale
+    mat3 NormalMatrix = transpose(inverse(mat3(Model)));
+    vNormal = NormalMatrix * aNormal;
+    vTangent = vec4(mat3(Model) * aTangent.xyz, aTangent.w);
 }
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include "simplify.h"
+#include "hash.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Symmetric 4x4 quadric, sum of squared distances to planes of the triangles around a vertex
+ *
+ */
+typedef struct Quadric {
+    double A00, A01, A02, A11, A12, A22;
+    double B0, B1, B2;
+    double C;
+    double Weight;
+} Quadric;
+
+typedef struct Collapse {
+    float Cost;
+    unsigned Source;
+    unsigned Target;
+} Collapse;
+
+static unsigned
+HashTableSize(unsigned count) {
+    unsigned TableSize = 1;
+    while(TableSize < count * 2) {
+        TableSize <<= 1;
+    }
+    return TableSize;
+}
+
+/**
+ * @brief Maps every vertex to the first vertex with bit-identical position. Vertices that differ
+ *        only in attributes share one entry, which is how seams are found.
+ *
+ */
+static int
+BuildPositionRemap(const MeshData* mesh, unsigned* remap) {
+    unsigned TableSize = HashTableSize(mesh->NumVertices);
+    unsigned* Table = (unsigned*)malloc(TableSize * sizeof(unsigned));
+    if(!Table) {
+        return LOAD_FAIL;
+    }
+
+    memset(Table, 0xFF, TableSize * sizeof(unsigned));
+    for(unsigned VertIdx = 0; VertIdx < mesh->NumVertices; ++VertIdx) {
+        const float* Position = mesh->Vertices[VertIdx].Position;
+        unsigned Slot = (unsigned)HashBytes(Position, 3 * sizeof(float), 0) & (TableSize - 1);
+        while(Table[Slot] != ~0u && memcmp(mesh->Vertices[Table[Slot]].Position, Position, 3 * sizeof(float))) {
+            Slot = (Slot + 1) & (TableSize - 1);
+        }
+
+        if(Table[Slot] == ~0u) {
+            Table[Slot] = VertIdx;
+        }
+        remap[VertIdx] = Table[Slot];
+    }
+
+    free(Table);
+    return LOAD_SUCCESS;
+}
+
+/**
+ * @brief Locks seam vertices and vertices on edges used by a single triangle
+ *
+ */
+static int
+FindLockedVertices(const unsigned* indices, unsigned numIndices, const unsigned* remap,
+                   unsigned numVertices, unsigned char* locked) {
+    memset(locked, 0, numVertices);
+    for(unsigned VertIdx = 0; VertIdx < numVertices; ++VertIdx) {
+        if(remap[VertIdx] != VertIdx) {
+            locked[VertIdx] = 1;
+            locked[remap[VertIdx]] = 1;
+        }
+    }
+
+    unsigned TableSize = HashTableSize(numIndices);
+    uint64_t* Edges = (uint64_t*)malloc(TableSize * sizeof(uint64_t));
+    if(!Edges) {
+        return LOAD_FAIL;
+    }
+
+    // NOTE(Jovan): Directed edges between positions, an edge whose reverse is missing lies on a border
+    memset(Edges, 0xFF, TableSize * sizeof(uint64_t));
+    for(unsigned Idx = 0; Idx < numIndices; ++Idx) {
+        unsigned From = remap[indices[Idx]];
+        unsigned To = remap[indices[Idx % 3 == 2 ? Idx - 2 : Idx + 1]];
+        uint64_t Key = (uint64_t)From << 32 | To;
+        unsigned Slot = (unsigned)HashBytes(&Key, sizeof(Key), 0) & (TableSize - 1);
+        while(Edges[Slot] != ~0ull && Edges[Slot] != Key) {
+            Slot = (Slot + 1) & (TableSize - 1);
+        }
+        Edges[Slot] = Key;
+    }
+
+    for(unsigned Idx = 0; Idx < numIndices; ++Idx) {
+        unsigned From = remap[indices[Idx]];
+        unsigned To = remap[indices[Idx % 3 == 2 ? Idx - 2 : Idx + 1]];
+        uint64_t Reverse = (uint64_t)To << 32 | From;
+        unsigned Slot = (unsigned)HashBytes(&Reverse, sizeof(Reverse), 0) & (TableSize - 1);
+        while(Edges[Slot] != ~0ull && Edges[Slot] != Reverse) {
+            Slot = (Slot + 1) & (TableSize - 1);
+        }
+        if(Edges[Slot] == ~0ull) {
+            locked[From] = 1;
+            locked[To] = 1;
+        }
+    }
+
+    free(Edges);
+    return LOAD_SUCCESS;
+}
+
+static void
+AddTriangleQuadric(Quadric* quadric, const float* p0, const float* p1, const float* p2) {
+    double E1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    double E2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    double N[3] = {
+        E1[1] * E2[2] - E1[2] * E2[1],
+        E1[2] * E2[0] - E1[0] * E2[2],
+        E1[0] * E2[1] - E1[1] * E2[0]
+    };
+    double Length = sqrt(N[0] * N[0] + N[1] * N[1] + N[2] * N[2]);
+    if(Length == 0.0) {
+        return;
+    }
+
+    // NOTE(Jovan): Planes are weighted by triangle area, so large faces dominate the error
+    double Weight = Length * 0.5;
+    N[0] /= Length;
+    N[1] /= Length;
+    N[2] /= Length;
+    double D = -(N[0] * p0[0] + N[1] * p0[1] + N[2] * p0[2]);
+    quadric->A00 += Weight * N[0] * N[0];
+    quadric->A01 += Weight * N[0] * N[1];
+    quadric->A02 += Weight * N[0] * N[2];
+    quadric->A11 += Weight * N[1] * N[1];
+    quadric->A12 += Weight * N[1] * N[2];
+    quadric->A22 += Weight * N[2] * N[2];
+    quadric->B0 += Weight * N[0] * D;
+    quadric->B1 += Weight * N[1] * D;
+    quadric->B2 += Weight * N[2] * D;
+    quadric->C += Weight * D * D;
+    quadric->Weight += Weight;
+}
+
+static void
+AddQuadric(Quadric* dst, const Quadric* src) {
+    dst->A00 += src->A00;
+    dst->A01 += src->A01;
+    dst->A02 += src->A02;
+    dst->A11 += src->A11;
+    dst->A12 += src->A12;
+    dst->A22 += src->A22;
+    dst->B0 += src->B0;
+    dst->B1 += src->B1;
+    dst->B2 += src->B2;
+    dst->C += src->C;
+    dst->Weight += src->Weight;
+}
+
+/**
+ * @brief Area weighted mean of squared distances from point to quadric planes
+ *
+ */
+static double
+QuadricError(const Quadric* quadric, const float* point) {
+    if(quadric->Weight <= 0.0) {
+        return 0.0;
+    }
+
+    double X = point[0], Y = point[1], Z = point[2];
+    double Error = quadric->A00 * X * X + quadric->A11 * Y * Y + quadric->A22 * Z * Z
+        + 2.0 * (quadric->A01 * X * Y + quadric->A02 * X * Z + quadric->A12 * Y * Z)
+        + 2.0 * (quadric->B0 * X + quadric->B1 * Y + quadric->B2 * Z)
+        + quadric->C;
+    return fabs(Error) / quadric->Weight;
+}
+
+static void
+TriangleNormal(const float* p0, const float* p1, const float* p2, float* normal) {
+    float E1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    float E2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    normal[0] = E1[1] * E2[2] - E1[2] * E2[1];
+    normal[1] = E1[2] * E2[0] - E1[0] * E2[2];
+    normal[2] = E1[0] * E2[1] - E1[1] * E2[0];
+}
+
+/**
+ * @brief Checks whether moving source onto target folds over any triangle that survives the collapse
+ *
+ */
+static int
+CollapseFlips(const MeshData* mesh, const unsigned* indices, const unsigned* adjacency,
+              unsigned numAdjacent, unsigned source, unsigned target) {
+    const float* TargetPosition = mesh->Vertices[target].Position;
+    for(unsigned AdjIdx = 0; AdjIdx < numAdjacent; ++AdjIdx) {
+        const unsigned* Triangle = &indices[adjacency[AdjIdx] * 3];
+        if(Triangle[0] == target || Triangle[1] == target || Triangle[2] == target) {
+            continue;
+        }
+
+        const float* Before[3];
+        const float* After[3];
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            Before[Corner] = mesh->Vertices[Triangle[Corner]].Position;
+            After[Corner] = Triangle[Corner] == source ? TargetPosition : Before[Corner];
+        }
+
+        float N0[3], N1[3];
+        TriangleNormal(Before[0], Before[1], Before[2], N0);
+        TriangleNormal(After[0], After[1], After[2], N1);
+        float Dot = N0[0] * N1[0] + N0[1] * N1[1] + N0[2] * N1[2];
+        float Lengths = sqrtf((N0[0] * N0[0] + N0[1] * N0[1] + N0[2] * N0[2]) * (N1[0] * N1[0] + N1[1] * N1[1] + N1[2] * N1[2]));
+        if(Lengths > 0.0f && Dot < SIMPLIFY_MIN_NORMAL_DOT * Lengths) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int
+CompareCollapses(const void* a, const void* b) {
+    const Collapse* CollapseA = (const Collapse*)a;
+    const Collapse* CollapseB = (const Collapse*)b;
+    if(CollapseA->Cost != CollapseB->Cost) {
+        return CollapseA->Cost < CollapseB->Cost ? -1 : 1;
+    }
+    return CollapseA->Source < CollapseB->Source ? -1 : 1;
+}
+
+int
+SimplifyMesh(const MeshData* mesh, const unsigned* indices, unsigned numIndices, unsigned targetIndices,
+             unsigned* destination, unsigned* numDestination, float* error) {
+    memcpy(destination, indices, numIndices * sizeof(unsigned));
+    *numDestination = numIndices;
+    *error = 0.0f;
+    unsigned NumVertices = mesh->NumVertices;
+    if(numIndices <= targetIndices || !NumVertices) {
+        return LOAD_SUCCESS;
+    }
+
+    unsigned* Remap = (unsigned*)malloc(NumVertices * sizeof(unsigned));
+    unsigned char* Locked = (unsigned char*)malloc(NumVertices);
+    unsigned char* Touched = (unsigned char*)malloc(NumVertices);
+    Quadric* Quadrics = (Quadric*)calloc(NumVertices, sizeof(Quadric));
+    Collapse* Best = (Collapse*)malloc(NumVertices * sizeof(Collapse));
+    Collapse* Candidates = (Collapse*)malloc(NumVertices * sizeof(Collapse));
+    unsigned* CollapseTarget = (unsigned*)malloc(NumVertices * sizeof(unsigned));
+    unsigned* AdjacencyOffsets = (unsigned*)malloc((NumVertices + 1) * sizeof(unsigned));
+    unsigned* Adjacency = (unsigned*)malloc(numIndices * sizeof(unsigned));
+    int Result = Remap && Locked && Touched && Quadrics && Best && Candidates && CollapseTarget
+        && AdjacencyOffsets && Adjacency
+        && BuildPositionRemap(mesh, Remap)
+        && FindLockedVertices(indices, numIndices, Remap, NumVertices, Locked);
+    if(!Result) {
+        fprintf(stderr, "Failed to allocate simplifier tables.\n");
+    }
+
+    // NOTE(Jovan): Quadrics live on positions, so vertices split by a seam accumulate the same planes
+    for(unsigned Idx = 0; Result && Idx < numIndices; Idx += 3) {
+        const float* P0 = mesh->Vertices[indices[Idx]].Position;
+        const float* P1 = mesh->Vertices[indices[Idx + 1]].Position;
+        const float* P2 = mesh->Vertices[indices[Idx + 2]].Position;
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            AddTriangleQuadric(&Quadrics[Remap[indices[Idx + Corner]]], P0, P1, P2);
+        }
+    }
+
+    double MaxError = 0.0;
+    unsigned NumIndices = numIndices;
+    for(unsigned Pass = 0; Result && Pass < SIMPLIFY_MAX_PASSES && NumIndices > targetIndices; ++Pass) {
+        memset(AdjacencyOffsets, 0, (NumVertices + 1) * sizeof(unsigned));
+        for(unsigned Idx = 0; Idx < NumIndices; ++Idx) {
+            ++AdjacencyOffsets[destination[Idx] + 1];
+        }
+        for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+            AdjacencyOffsets[VertIdx + 1] += AdjacencyOffsets[VertIdx];
+            Best[VertIdx].Cost = FLT_MAX;
+        }
+        for(unsigned Idx = 0; Idx < NumIndices; ++Idx) {
+            Adjacency[AdjacencyOffsets[destination[Idx]]++] = Idx / 3;
+        }
+        // NOTE(Jovan): Filling advanced every offset to the start of the next list, shift them back
+        memmove(&AdjacencyOffsets[1], AdjacencyOffsets, NumVertices * sizeof(unsigned));
+        AdjacencyOffsets[0] = 0;
+
+        // NOTE(Jovan): Cheapest edge per source vertex, cost is the error of the source quadric at the target
+        for(unsigned Idx = 0; Idx < NumIndices; ++Idx) {
+            unsigned Source = destination[Idx];
+            if(Locked[Remap[Source]]) {
+                continue;
+            }
+            unsigned First = Idx - Idx % 3;
+            for(unsigned Corner = 0; Corner < 3; ++Corner) {
+                unsigned Target = destination[First + Corner];
+                if(Remap[Target] == Remap[Source]) {
+                    continue;
+                }
+                float Cost = (float)QuadricError(&Quadrics[Remap[Source]], mesh->Vertices[Target].Position);
+                if(Cost < Best[Source].Cost) {
+                    Best[Source].Cost = Cost;
+                    Best[Source].Source = Source;
+                    Best[Source].Target = Target;
+                }
+            }
+        }
+
+        unsigned NumCandidates = 0;
+        for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+            if(Best[VertIdx].Cost != FLT_MAX) {
+                Candidates[NumCandidates++] = Best[VertIdx];
+            }
+        }
+        qsort(Candidates, NumCandidates, sizeof(Collapse), CompareCollapses);
+
+        // NOTE(Jovan): Interior collapse removes two triangles. Neighbourhoods of collapsed vertices
+        // are frozen for the rest of the pass so flip checks stay valid.
+        unsigned Goal = (NumIndices - targetIndices) / 6 + 1;
+        unsigned NumCollapsed = 0;
+        memset(Touched, 0, NumVertices);
+        memset(CollapseTarget, 0xFF, NumVertices * sizeof(unsigned));
+        for(unsigned CandidateIdx = 0; CandidateIdx < NumCandidates && NumCollapsed < Goal; ++CandidateIdx) {
+            const Collapse* Candidate = &Candidates[CandidateIdx];
+            unsigned Source = Candidate->Source, Target = Candidate->Target;
+            const unsigned* Adjacent = &Adjacency[AdjacencyOffsets[Source]];
+            unsigned NumAdjacent = AdjacencyOffsets[Source + 1] - AdjacencyOffsets[Source];
+            if(Touched[Source] || Touched[Target]
+               || CollapseFlips(mesh, destination, Adjacent, NumAdjacent, Source, Target)) {
+                continue;
+            }
+
+            CollapseTarget[Source] = Target;
+            for(unsigned AdjIdx = 0; AdjIdx < NumAdjacent; ++AdjIdx) {
+                for(unsigned Corner = 0; Corner < 3; ++Corner) {
+                    Touched[destination[Adjacent[AdjIdx] * 3 + Corner]] = 1;
+                }
+            }
+            AddQuadric(&Quadrics[Remap[Target]], &Quadrics[Remap[Source]]);
+            MaxError = Candidate->Cost > MaxError ? Candidate->Cost : MaxError;
+            ++NumCollapsed;
+        }
+
+        if(!NumCollapsed) {
+            break;
+        }
+
+        unsigned NumWritten = 0;
+        for(unsigned Idx = 0; Idx < NumIndices; Idx += 3) {
+            unsigned Triangle[3];
+            for(unsigned Corner = 0; Corner < 3; ++Corner) {
+                unsigned VertIdx = destination[Idx + Corner];
+                Triangle[Corner] = CollapseTarget[VertIdx] != ~0u ? CollapseTarget[VertIdx] : VertIdx;
+            }
+            // NOTE(Jovan): Triangles whose corners share a position have no area left
+            if(Remap[Triangle[0]] == Remap[Triangle[1]] || Remap[Triangle[1]] == Remap[Triangle[2]]
+               || Remap[Triangle[2]] == Remap[Triangle[0]]) {
+                continue;
+            }
+            memcpy(&destination[NumWritten], Triangle, sizeof(Triangle));
+            NumWritten += 3;
+        }
+        NumIndices = NumWritten;
+    }
+
+    if(Result) {
+        *numDestination = NumIndices;
+        *error = (float)sqrt(MaxError);
+    }
+    free(Remap);
+    free(Locked);
+    free(Touched);
+    free(Quadrics);
+    free(Best);
+    free(Candidates);
+    free(CollapseTarget);
+    free(AdjacencyOffsets);
+    free(Adjacency);
+    return Result;
+}
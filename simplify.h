@@ -0,0 +1,39 @@
+/**
+ * @file simplify.h
+ * @author Jovan Ivosevic
+ * @brief Quadric error metric edge-collapse simplification of indexed meshes
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "model.h"
+
+// NOTE(Jovan): Collapses that turn a neighbouring triangle further than this cosine are rejected
+#define SIMPLIFY_MIN_NORMAL_DOT 0.25f
+#define SIMPLIFY_MAX_PASSES 64
+
+/**
+ * @brief Reduces triangle count by collapsing edges onto existing vertices, so the result indexes
+ *        the unchanged vertex array of the mesh. Vertices shared by several attribute sets (seams) and
+ *        vertices on open borders are never moved, which keeps seams and mesh outline intact.
+ *        Simplification stops at the target or once no collapse is possible.
+ *
+ * @param mesh Mesh whose vertices are referenced by indices
+ * @param indices Triangle list to be simplified, may differ from mesh indices
+ * @param numIndices Number of indices
+ * @param targetIndices Desired number of indices
+ * @param destination Result, must hold numIndices indices
+ * @param numDestination Output number of indices written to destination
+ * @param error Output largest collapse error, as distance in mesh units
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int SimplifyMesh(const MeshData* mesh, const unsigned* indices, unsigned numIndices, unsigned targetIndices,
+                 unsigned* destination, unsigned* numDestination, float* error);
+
+#endif
@@ -0,0 +1,278 @@
+#include "tangentspace.h"
+#include "jobs.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define TANGENT_SIMD 1
+#include <xmmintrin.h>
+#else
+#define TANGENT_SIMD 0
+#endif
+
+// NOTE(Jovan): Abramowitz and Stegun 4.4.45, absolute error below 7e-5 radians is plenty for weights
+#define ACOS_C0 1.5707288f
+#define ACOS_C1 -0.2121144f
+#define ACOS_C2 0.0742610f
+#define ACOS_C3 -0.0187293f
+#define TANGENT_PI 3.14159265f
+
+typedef struct TangentContext {
+    MeshData* Mesh;
+    // NOTE(Jovan): Face normal scaled by corner angle, three floats per index in index order
+    float* Corners;
+    const unsigned* CornerOffsets;
+    const unsigned* CornerList;
+} TangentContext;
+
+static float
+AcosApprox(float x) {
+    float Abs = fabsf(x);
+    float Result = sqrtf(1.0f - Abs) * (ACOS_C0 + Abs * (ACOS_C1 + Abs * (ACOS_C2 + Abs * ACOS_C3)));
+    return x < 0.0f ? TANGENT_PI - Result : Result;
+}
+
+static float
+CornerCosine(float dot, float lengthA2, float lengthB2) {
+    float Cosine = dot / sqrtf(fmaxf(lengthA2 * lengthB2, FLT_MIN));
+    return fminf(fmaxf(Cosine, -1.0f), 1.0f);
+}
+
+/**
+ * @brief Unnormalized cross product of triangle edges, its length is twice the area which gives the area weighting
+ *
+ */
+static void
+FaceNormalOf(const Vertex* vertices, const unsigned* triangle, float* normal) {
+    const float* P0 = vertices[triangle[0]].Position;
+    const float* P1 = vertices[triangle[1]].Position;
+    const float* P2 = vertices[triangle[2]].Position;
+    float E01[3] = { P1[0] - P0[0], P1[1] - P0[1], P1[2] - P0[2] };
+    float E02[3] = { P2[0] - P0[0], P2[1] - P0[1], P2[2] - P0[2] };
+    normal[0] = E01[1] * E02[2] - E01[2] * E02[1];
+    normal[1] = E01[2] * E02[0] - E01[0] * E02[2];
+    normal[2] = E01[0] * E02[1] - E01[1] * E02[0];
+}
+
+static void
+CornerWeights(const Vertex* vertices, const unsigned* triangle, float* corners) {
+    const float* P0 = vertices[triangle[0]].Position;
+    const float* P1 = vertices[triangle[1]].Position;
+    const float* P2 = vertices[triangle[2]].Position;
+    float E01[3] = { P1[0] - P0[0], P1[1] - P0[1], P1[2] - P0[2] };
+    float E02[3] = { P2[0] - P0[0], P2[1] - P0[1], P2[2] - P0[2] };
+    float E12[3] = { P2[0] - P1[0], P2[1] - P1[1], P2[2] - P1[2] };
+    float Normal[3];
+    FaceNormalOf(vertices, triangle, Normal);
+    float L01 = E01[0] * E01[0] + E01[1] * E01[1] + E01[2] * E01[2];
+    float L02 = E02[0] * E02[0] + E02[1] * E02[1] + E02[2] * E02[2];
+    float L12 = E12[0] * E12[0] + E12[1] * E12[1] + E12[2] * E12[2];
+    float Angles[3] = {
+        AcosApprox(CornerCosine(E01[0] * E02[0] + E01[1] * E02[1] + E01[2] * E02[2], L01, L02)),
+        AcosApprox(CornerCosine(-(E01[0] * E12[0] + E01[1] * E12[1] + E01[2] * E12[2]), L01, L12)),
+        AcosApprox(CornerCosine(E02[0] * E12[0] + E02[1] * E12[1] + E02[2] * E12[2], L02, L12))
+    };
+
+    for(unsigned Corner = 0; Corner < 3; ++Corner) {
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            corners[Corner * 3 + Axis] = Angles[Corner] * Normal[Axis];
+        }
+    }
+}
+
+#if TANGENT_SIMD
+static __m128
+AcosApprox4(__m128 x) {
+    __m128 Abs = _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+    __m128 Poly = _mm_add_ps(_mm_set1_ps(ACOS_C2), _mm_mul_ps(Abs, _mm_set1_ps(ACOS_C3)));
+    Poly = _mm_add_ps(_mm_set1_ps(ACOS_C1), _mm_mul_ps(Abs, Poly));
+    Poly = _mm_add_ps(_mm_set1_ps(ACOS_C0), _mm_mul_ps(Abs, Poly));
+    __m128 Result = _mm_mul_ps(_mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), Abs), _mm_setzero_ps())), Poly);
+    __m128 Negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(Negative, _mm_sub_ps(_mm_set1_ps(TANGENT_PI), Result)), _mm_andnot_ps(Negative, Result));
+}
+
+static __m128
+Dot4(const __m128* a, const __m128* b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+}
+
+static __m128
+CornerCosine4(__m128 dot, __m128 lengthA2, __m128 lengthB2) {
+    __m128 Cosine = _mm_div_ps(dot, _mm_sqrt_ps(_mm_max_ps(_mm_mul_ps(lengthA2, lengthB2), _mm_set1_ps(FLT_MIN))));
+    return _mm_min_ps(_mm_max_ps(Cosine, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+/**
+ * @brief Same as CornerWeights for four triangles at once, positions are transposed into one lane per triangle
+ *
+ */
+static void
+CornerWeights4(const Vertex* vertices, const unsigned* triangles, float* corners) {
+    float Lanes[3][3][4];
+    for(unsigned Lane = 0; Lane < 4; ++Lane) {
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            const float* Position = vertices[triangles[Lane * 3 + Corner]].Position;
+            Lanes[Corner][0][Lane] = Position[0];
+            Lanes[Corner][1][Lane] = Position[1];
+            Lanes[Corner][2][Lane] = Position[2];
+        }
+    }
+
+    __m128 P[3][3];
+    for(unsigned Corner = 0; Corner < 3; ++Corner) {
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            P[Corner][Axis] = _mm_loadu_ps(Lanes[Corner][Axis]);
+        }
+    }
+
+    __m128 E01[3], E02[3], E12[3];
+    for(unsigned Axis = 0; Axis < 3; ++Axis) {
+        E01[Axis] = _mm_sub_ps(P[1][Axis], P[0][Axis]);
+        E02[Axis] = _mm_sub_ps(P[2][Axis], P[0][Axis]);
+        E12[Axis] = _mm_sub_ps(P[2][Axis], P[1][Axis]);
+    }
+    __m128 Normal[3] = {
+        _mm_sub_ps(_mm_mul_ps(E01[1], E02[2]), _mm_mul_ps(E01[2], E02[1])),
+        _mm_sub_ps(_mm_mul_ps(E01[2], E02[0]), _mm_mul_ps(E01[0], E02[2])),
+        _mm_sub_ps(_mm_mul_ps(E01[0], E02[1]), _mm_mul_ps(E01[1], E02[0]))
+    };
+    __m128 L01 = Dot4(E01, E01), L02 = Dot4(E02, E02), L12 = Dot4(E12, E12);
+    __m128 Angles[3] = {
+        AcosApprox4(CornerCosine4(Dot4(E01, E02), L01, L02)),
+        AcosApprox4(CornerCosine4(_mm_sub_ps(_mm_setzero_ps(), Dot4(E01, E12)), L01, L12)),
+        AcosApprox4(CornerCosine4(Dot4(E02, E12), L02, L12))
+    };
+
+    for(unsigned Corner = 0; Corner < 3; ++Corner) {
+        for(unsigned Axis = 0; Axis < 3; ++Axis) {
+            _mm_storeu_ps(Lanes[Corner][Axis], _mm_mul_ps(Angles[Corner], Normal[Axis]));
+        }
+    }
+    for(unsigned Lane = 0; Lane < 4; ++Lane) {
+        for(unsigned Corner = 0; Corner < 3; ++Corner) {
+            for(unsigned Axis = 0; Axis < 3; ++Axis) {
+                corners[Lane * 9 + Corner * 3 + Axis] = Lanes[Corner][Axis][Lane];
+            }
+        }
+    }
+}
+#endif
+
+static void
+CornerWeightsJob(void* data, unsigned chunkIdx) {
+    TangentContext* Context = (TangentContext*)data;
+    const MeshData* Mesh = Context->Mesh;
+    unsigned NumTriangles = Mesh->NumIndices / 3;
+    unsigned TriIdx = chunkIdx * TANGENT_CHUNK_TRIANGLES;
+    unsigned LastTriangle = TriIdx + TANGENT_CHUNK_TRIANGLES < NumTriangles ? TriIdx + TANGENT_CHUNK_TRIANGLES : NumTriangles;
+#if TANGENT_SIMD
+    for(; TriIdx + 4 <= LastTriangle; TriIdx += 4) {
+        CornerWeights4(Mesh->Vertices, &Mesh->Indices[TriIdx * 3], &Context->Corners[TriIdx * 9]);
+    }
+#endif
+    for(; TriIdx < LastTriangle; ++TriIdx) {
+        CornerWeights(Mesh->Vertices, &Mesh->Indices[TriIdx * 3], &Context->Corners[TriIdx * 9]);
+    }
+}
+
+static void
+VertexFrameJob(void* data, unsigned chunkIdx) {
+    TangentContext* Context = (TangentContext*)data;
+    MeshData* Mesh = Context->Mesh;
+    unsigned FirstVertex = chunkIdx * TANGENT_CHUNK_VERTICES;
+    unsigned LastVertex = FirstVertex + TANGENT_CHUNK_VERTICES < Mesh->NumVertices ? FirstVertex + TANGENT_CHUNK_VERTICES : Mesh->NumVertices;
+    for(unsigned VertIdx = FirstVertex; VertIdx < LastVertex; ++VertIdx) {
+        // NOTE(Jovan): Corners are summed in index order, so results don't depend on the number of workers
+        float Normal[3] = { 0.0f, 0.0f, 0.0f };
+        for(unsigned ListIdx = Context->CornerOffsets[VertIdx]; ListIdx < Context->CornerOffsets[VertIdx + 1]; ++ListIdx) {
+            const float* Corner = &Context->Corners[Context->CornerList[ListIdx] * 3];
+            Normal[0] += Corner[0];
+            Normal[1] += Corner[1];
+            Normal[2] += Corner[2];
+        }
+
+        float Length = sqrtf(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+        if(Length == 0.0f) {
+            // NOTE(Jovan): Sliver triangles round their small corner angles to 0, fall back to area weighting only
+            for(unsigned ListIdx = Context->CornerOffsets[VertIdx]; ListIdx < Context->CornerOffsets[VertIdx + 1]; ++ListIdx) {
+                const unsigned* Triangle = &Mesh->Indices[Context->CornerList[ListIdx] / 3 * 3];
+                float FaceNormal[3];
+                FaceNormalOf(Mesh->Vertices, Triangle, FaceNormal);
+                Normal[0] += FaceNormal[0];
+                Normal[1] += FaceNormal[1];
+                Normal[2] += FaceNormal[2];
+            }
+            Length = sqrtf(Normal[0] * Normal[0] + Normal[1] * Normal[1] + Normal[2] * Normal[2]);
+        }
+        if(Length > 0.0f) {
+            Normal[0] /= Length;
+            Normal[1] /= Length;
+            Normal[2] /= Length;
+        } else {
+            Normal[0] = Normal[1] = 0.0f;
+            Normal[2] = 1.0f;
+        }
+
+        // NOTE(Jovan): Branchless orthonormal basis of Duff et al., continuous everywhere except the -Z pole
+        Vertex* CurrVertex = &Mesh->Vertices[VertIdx];
+        float Sign = Normal[2] >= 0.0f ? 1.0f : -1.0f;
+        float A = -1.0f / (Sign + Normal[2]);
+        float B = Normal[0] * Normal[1] * A;
+        memcpy(CurrVertex->Normal, Normal, sizeof(Normal));
+        CurrVertex->Tangent[0] = 1.0f + Sign * Normal[0] * Normal[0] * A;
+        CurrVertex->Tangent[1] = Sign * B;
+        CurrVertex->Tangent[2] = -Sign * Normal[0];
+        CurrVertex->Tangent[3] = 1.0f;
+    }
+}
+
+int
+ComputeTangentSpace(MeshData* mesh) {
+    unsigned NumTriangles = mesh->NumIndices / 3;
+    unsigned NumVertices = mesh->NumVertices;
+    if(!NumTriangles || !NumVertices) {
+        return LOAD_SUCCESS;
+    }
+
+    float* Corners = (float*)malloc((size_t)NumTriangles * 9 * sizeof(float));
+    unsigned* CornerOffsets = (unsigned*)calloc(NumVertices + 1, sizeof(unsigned));
+    unsigned* CornerList = (unsigned*)malloc((size_t)NumTriangles * 3 * sizeof(unsigned));
+    if(!Corners || !CornerOffsets || !CornerList) {
+        fprintf(stderr, "Failed to allocate tangent space tables.\n");
+        free(Corners);
+        free(CornerOffsets);
+        free(CornerList);
+        return LOAD_FAIL;
+    }
+
+    TangentContext Context;
+    Context.Mesh = mesh;
+    Context.Corners = Corners;
+    Context.CornerOffsets = CornerOffsets;
+    Context.CornerList = CornerList;
+    JobParallelFor((NumTriangles + TANGENT_CHUNK_TRIANGLES - 1) / TANGENT_CHUNK_TRIANGLES, CornerWeightsJob, &Context);
+
+    // NOTE(Jovan): Corners grouped by vertex, so every vertex is summed by exactly one task without atomics
+    for(unsigned Idx = 0; Idx < NumTriangles * 3; ++Idx) {
+        ++CornerOffsets[mesh->Indices[Idx] + 1];
+    }
+    for(unsigned VertIdx = 0; VertIdx < NumVertices; ++VertIdx) {
+        CornerOffsets[VertIdx + 1] += CornerOffsets[VertIdx];
+    }
+    for(unsigned Idx = 0; Idx < NumTriangles * 3; ++Idx) {
+        CornerList[CornerOffsets[mesh->Indices[Idx]]++] = Idx;
+    }
+    // NOTE(Jovan): Filling advanced every offset to the start of the next list, shift them back
+    memmove(&CornerOffsets[1], CornerOffsets, NumVertices * sizeof(unsigned));
+    CornerOffsets[0] = 0;
+
+    JobParallelFor((NumVertices + TANGENT_CHUNK_VERTICES - 1) / TANGENT_CHUNK_VERTICES, VertexFrameJob, &Context);
+
+    free(Corners);
+    free(CornerOffsets);
+    free(CornerList);
+    return LOAD_SUCCESS;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file tangentspace.h
+ * @author Jovan Ivosevic
+ * @brief Parallel smooth normal and tangent frame generation
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef TANGENTSPACE_H
+#define TANGENTSPACE_H
+
+#include "model.h"
+
+// NOTE(Jovan): Triangles per parallel task, small meshes run as a single task
+#define TANGENT_CHUNK_TRIANGLES 16384
+#define TANGENT_CHUNK_VERTICES 16384
+
+/**
+ * @brief Computes smooth vertex normals as the sum of adjacent face normals weighted by triangle
+ *        area and corner angle, followed by a tangent frame per vertex. Importers carry no texture
+ *        coordinates, so tangents are an orthonormal basis around the normal with handedness +1
+ *        instead of being aligned to UV derivatives. Work is split over worker threads by triangle
+ *        and vertex ranges. Meshes without indices are left untouched.
+ *
+ * @param mesh Welded mesh, normals and tangents of its vertices are overwritten
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int ComputeTangentSpace(MeshData* mesh);
+
+#endif
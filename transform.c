@@ -0,0 +1,118 @@
+#include "transform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Transform {
+    vec3 Position;
+    versor Rotation;
+    vec3 Scale;
+    TransformId Parent;
+    int Dirty;
+    // NOTE(Jovan): Set during the update that recomputed the world matrix, tells children to follow
+    int Changed;
+} Transform;
+
+// NOTE(Jovan): World matrices live apart from local state so the cached data stays densely packed
+static Transform* sTransforms;
+static mat4* sWorlds;
+static unsigned sNumTransforms;
+static unsigned sCapacity;
+
+TransformId
+CreateTransform(TransformId parent) {
+    if(parent != TRANSFORM_NONE && parent >= sNumTransforms) {
+        fprintf(stderr, "Transform parent %u does not exist.\n", parent);
+        return TRANSFORM_NONE;
+    }
+
+    if(sNumTransforms == sCapacity) {
+        unsigned Capacity = sCapacity ? 2 * sCapacity : 64;
+        Transform* Transforms = (Transform*)realloc(sTransforms, Capacity * sizeof(Transform));
+        if(!Transforms) {
+            fprintf(stderr, "Failed to allocate transforms.\n");
+            return TRANSFORM_NONE;
+        }
+        sTransforms = Transforms;
+        mat4* Worlds = (mat4*)realloc(sWorlds, Capacity * sizeof(mat4));
+        if(!Worlds) {
+            fprintf(stderr, "Failed to allocate transforms.\n");
+            return TRANSFORM_NONE;
+        }
+        sWorlds = Worlds;
+        sCapacity = Capacity;
+    }
+
+    TransformId Id = sNumTransforms++;
+    Transform* CurrTransform = &sTransforms[Id];
+    memset(CurrTransform, 0, sizeof(Transform));
+    glm_quat_identity(CurrTransform->Rotation);
+    glm_vec3_one(CurrTransform->Scale);
+    CurrTransform->Parent = parent;
+    CurrTransform->Dirty = 1;
+    glm_mat4_identity(sWorlds[Id]);
+    return Id;
+}
+
+void
+SetTransformPosition(TransformId id, vec3 position) {
+    glm_vec3_copy(position, sTransforms[id].Position);
+    sTransforms[id].Dirty = 1;
+}
+
+void
+SetTransformRotation(TransformId id, versor rotation) {
+    glm_quat_copy(rotation, sTransforms[id].Rotation);
+    sTransforms[id].Dirty = 1;
+}
+
+void
+SetTransformScale(TransformId id, vec3 scale) {
+    glm_vec3_copy(scale, sTransforms[id].Scale);
+    sTransforms[id].Dirty = 1;
+}
+
+unsigned
+UpdateTransforms(void) {
+    unsigned NumUpdated = 0;
+    for(TransformId Id = 0; Id < sNumTransforms; ++Id) {
+        Transform* CurrTransform = &sTransforms[Id];
+        int ParentChanged = CurrTransform->Parent != TRANSFORM_NONE && sTransforms[CurrTransform->Parent].Changed;
+        CurrTransform->Changed = CurrTransform->Dirty || ParentChanged;
+        if(!CurrTransform->Changed) {
+            continue;
+        }
+
+        // NOTE(Jovan): Translation * rotation * scale written directly, scale multiplies rotation columns
+        mat4 Local;
+        glm_quat_mat4(CurrTransform->Rotation, Local);
+        glm_vec4_scale(Local[0], CurrTransform->Scale[0], Local[0]);
+        glm_vec4_scale(Local[1], CurrTransform->Scale[1], Local[1]);
+        glm_vec4_scale(Local[2], CurrTransform->Scale[2], Local[2]);
+        glm_vec3_copy(CurrTransform->Position, Local[3]);
+        if(CurrTransform->Parent != TRANSFORM_NONE) {
+            glm_mat4_mul(sWorlds[CurrTransform->Parent], Local, sWorlds[Id]);
+        } else {
+            glm_mat4_copy(Local, sWorlds[Id]);
+        }
+        CurrTransform->Dirty = 0;
+        ++NumUpdated;
+    }
+    return NumUpdated;
+}
+
+vec4*
+GetWorldMatrix(TransformId id) {
+    return sWorlds[id];
+}
+
+void
+ClearTransforms(void) {
+    free(sTransforms);
+    free(sWorlds);
+    sTransforms = NULL;
+    sWorlds = NULL;
+    sNumTransforms = 0;
+    sCapacity = 0;
+}
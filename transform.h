@@ -0,0 +1,65 @@
+/**
+ * @file transform.h
+ * @author Jovan Ivosevic
+ * @brief Transform store keeping local translation, rotation and scale with cached world matrices
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#define TRANSFORM_NONE 0xFFFFFFFFu
+
+#include "cglm/cglm.h"
+
+/**
+ * @brief Index of a transform in the store
+ *
+ */
+typedef unsigned TransformId;
+
+/**
+ * @brief Adds identity transform. Parents must be created before their children, which lets
+ *        UpdateTransforms resolve the whole hierarchy in one pass in creation order.
+ *
+ * @param parent Parent transform or TRANSFORM_NONE
+ * @return TransformId New transform, TRANSFORM_NONE on failure
+ */
+TransformId CreateTransform(TransformId parent);
+
+/**
+ * @brief Setters of local translation, rotation and scale. World matrix of the transform and of
+ *        its descendants is recomputed on the next UpdateTransforms.
+ *
+ */
+void SetTransformPosition(TransformId id, vec3 position);
+void SetTransformRotation(TransformId id, versor rotation);
+void SetTransformScale(TransformId id, vec3 scale);
+
+/**
+ * @brief Recomputes world matrices of transforms changed since the last update, as parent world
+ *        times translation, rotation and scale. Untouched transforms cost one flag test.
+ *
+ * @return unsigned Number of recomputed world matrices
+ */
+unsigned UpdateTransforms(void);
+
+/**
+ * @brief Returns cached world matrix as of the last UpdateTransforms
+ *
+ * @param id Transform
+ * @return vec4* World matrix, valid until the next CreateTransform or ClearTransforms
+ */
+vec4* GetWorldMatrix(TransformId id);
+
+/**
+ * @brief Removes all transforms and frees the store
+ *
+ */
+void ClearTransforms(void);
+
+#endif
@@ -0,0 +1,464 @@
+#include "vfs.h"
+#include "hash.h"
+#include "jobs.h"
+#include "lz.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static MappedFile sPack;
+static const PackHeader* sHeader;
+static int64_t sPackModifiedTime;
+
+static uint64_t
+AlignUp(uint64_t value) {
+    return (value + VFS_PACK_ALIGNMENT - 1) & ~(uint64_t)(VFS_PACK_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Converts path to the form stored in packs: forward slashes, no leading "./"
+ *
+ * @return size_t Length of normalized path, 0 if it doesn't fit
+ */
+static size_t
+NormalizePath(const char* filePath, char* path) {
+    while(filePath[0] == '.' && (filePath[1] == '/' || filePath[1] == '\\')) {
+        filePath += 2;
+    }
+
+    size_t Length = strlen(filePath);
+    if(!Length || Length >= VFS_MAX_PATH) {
+        return 0;
+    }
+
+    for(size_t CharIdx = 0; CharIdx <= Length; ++CharIdx) {
+        path[CharIdx] = filePath[CharIdx] == '\\' ? '/' : filePath[CharIdx];
+    }
+    return Length;
+}
+
+static const PackEntry*
+PackSlots(void) {
+    return (const PackEntry*)(sPack.Data + sHeader->TocOffset);
+}
+
+static int
+ValidatePack(const char* image, size_t size) {
+    const PackHeader* Header = (const PackHeader*)image;
+    if(size < sizeof(PackHeader) || Header->Magic != VFS_PACK_MAGIC || Header->Version != VFS_PACK_VERSION
+       || Header->FileSize != size) {
+        return 0;
+    }
+
+    uint64_t TocSize = (uint64_t)Header->NumSlots * sizeof(PackEntry);
+    if(!Header->NumSlots || (Header->NumSlots & (Header->NumSlots - 1)) || Header->NumEntries > Header->NumSlots
+       || Header->TocOffset % VFS_PACK_ALIGNMENT || Header->TocOffset > size || TocSize > size - Header->TocOffset
+       || Header->StringsOffset != Header->TocOffset + TocSize) {
+        return 0;
+    }
+
+    const PackEntry* Slots = (const PackEntry*)(image + Header->TocOffset);
+    uint64_t StringsSize = size - Header->StringsOffset;
+    for(uint32_t SlotIdx = 0; SlotIdx < Header->NumSlots; ++SlotIdx) {
+        const PackEntry* Curr = &Slots[SlotIdx];
+        if(!Curr->PathLength) {
+            continue;
+        }
+        if(Curr->Offset > Header->TocOffset || Curr->StoredSize > Header->TocOffset - Curr->Offset
+           || Curr->PathOffset > StringsSize || Curr->PathLength > StringsSize - Curr->PathOffset) {
+            return 0;
+        }
+        // NOTE(Jovan): Block sizes are checked against StoredSize when the entry is decompressed
+        uint64_t NumBlocks = (Curr->Size + VFS_BLOCK_SIZE - 1) / VFS_BLOCK_SIZE;
+        if(Curr->NumBlocks ? Curr->NumBlocks != NumBlocks || NumBlocks * sizeof(uint32_t) > Curr->StoredSize
+                           : Curr->StoredSize != Curr->Size) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int
+VfsMount(const char* packPath) {
+    VfsUnmount();
+    uint64_t Size;
+    int64_t ModifiedTime;
+    if(!PlatformFileStat(packPath, &Size, &ModifiedTime) || !PlatformMapFile(packPath, &sPack)) {
+        return VFS_FAIL;
+    }
+
+    if(!ValidatePack(sPack.Data, sPack.Size)) {
+        fprintf(stderr, "Ignoring corrupt asset pack %s.\n", packPath);
+        PlatformUnmapFile(&sPack);
+        return VFS_FAIL;
+    }
+
+    sHeader = (const PackHeader*)sPack.Data;
+    sPackModifiedTime = ModifiedTime;
+    return VFS_SUCCESS;
+}
+
+void
+VfsUnmount(void) {
+    PlatformUnmapFile(&sPack);
+    sHeader = NULL;
+    sPackModifiedTime = 0;
+}
+
+static const PackEntry*
+FindEntry(const char* filePath) {
+    char Path[VFS_MAX_PATH];
+    size_t Length;
+    if(!sHeader || !(Length = NormalizePath(filePath, Path))) {
+        return NULL;
+    }
+
+    const PackEntry* Slots = PackSlots();
+    const char* Strings = sPack.Data + sHeader->StringsOffset;
+    uint64_t Hash = HashBytes(Path, Length, 0);
+    uint32_t Mask = sHeader->NumSlots - 1;
+    for(uint32_t Probe = 0, SlotIdx = (uint32_t)Hash & Mask; Probe < sHeader->NumSlots; ++Probe, SlotIdx = (SlotIdx + 1) & Mask) {
+        const PackEntry* Curr = &Slots[SlotIdx];
+        if(!Curr->PathLength) {
+            return NULL;
+        }
+        if(Curr->PathHash == Hash && Curr->PathLength == Length && !memcmp(Strings + Curr->PathOffset, Path, Length)) {
+            return Curr;
+        }
+    }
+    return NULL;
+}
+
+typedef struct BlockJob {
+    const unsigned char* Stored;
+    const uint64_t* Offsets;
+    unsigned char* Destination;
+    uint64_t Size;
+    volatile long Failed;
+} BlockJob;
+
+static void
+DecompressBlock(void* data, unsigned blockIdx) {
+    BlockJob* Job = (BlockJob*)data;
+    uint64_t Begin = (uint64_t)blockIdx * VFS_BLOCK_SIZE;
+    size_t RawSize = (size_t)(Job->Size - Begin < VFS_BLOCK_SIZE ? Job->Size - Begin : VFS_BLOCK_SIZE);
+    size_t StoredSize = (size_t)(Job->Offsets[blockIdx + 1] - Job->Offsets[blockIdx]);
+    const unsigned char* Source = Job->Stored + Job->Offsets[blockIdx];
+    if(StoredSize == RawSize) {
+        memcpy(Job->Destination + Begin, Source, RawSize);
+    } else if(!LzDecompress(Source, StoredSize, Job->Destination + Begin, RawSize)) {
+        AtomicStore(&Job->Failed, 1);
+    }
+}
+
+/**
+ * @brief Decompresses packed entry into destination of at least entry->Size bytes
+ *
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+static int
+DecompressEntry(const PackEntry* entry, void* destination) {
+    uint64_t* Offsets = (uint64_t*)malloc(((size_t)entry->NumBlocks + 1) * sizeof(uint64_t));
+    if(!Offsets) {
+        fprintf(stderr, "Failed to allocate asset block table.\n");
+        return VFS_FAIL;
+    }
+
+    BlockJob Job = { 0 };
+    Job.Stored = (const unsigned char*)sPack.Data + entry->Offset;
+    Job.Offsets = Offsets;
+    Job.Destination = (unsigned char*)destination;
+    Job.Size = entry->Size;
+    const uint32_t* BlockSizes = (const uint32_t*)Job.Stored;
+    Offsets[0] = (uint64_t)entry->NumBlocks * sizeof(uint32_t);
+    for(uint32_t BlockIdx = 0; BlockIdx < entry->NumBlocks; ++BlockIdx) {
+        Offsets[BlockIdx + 1] = Offsets[BlockIdx] + BlockSizes[BlockIdx];
+    }
+
+    if(Offsets[entry->NumBlocks] != entry->StoredSize) {
+        free(Offsets);
+        return VFS_FAIL;
+    }
+
+    JobParallelFor(entry->NumBlocks, DecompressBlock, &Job);
+    free(Offsets);
+    return AtomicLoad(&Job.Failed) ? VFS_FAIL : VFS_SUCCESS;
+}
+
+int
+VfsOpenFile(const char* filePath, VfsFile* file) {
+    memset(file, 0, sizeof(VfsFile));
+    const PackEntry* Entry = FindEntry(filePath);
+    if(Entry) {
+        file->ModifiedTime = sPackModifiedTime;
+    }
+    if(Entry && !Entry->NumBlocks) {
+        file->Data = sPack.Data + Entry->Offset;
+        file->Size = (size_t)Entry->Size;
+        return VFS_SUCCESS;
+    }
+
+    if(Entry) {
+        file->Memory = malloc((size_t)Entry->Size);
+        if(!file->Memory || !DecompressEntry(Entry, file->Memory)) {
+            fprintf(stderr, "Failed to decompress packed asset %s.\n", filePath);
+            VfsCloseFile(file);
+            return VFS_FAIL;
+        }
+        file->Data = (const char*)file->Memory;
+        file->Size = (size_t)Entry->Size;
+        return VFS_SUCCESS;
+    }
+
+    if(!PlatformMapFile(filePath, &file->Mapping)) {
+        return VFS_FAIL;
+    }
+    file->Data = file->Mapping.Data;
+    file->Size = file->Mapping.Size;
+    file->ModifiedTime = file->Mapping.ModifiedTime;
+    return VFS_SUCCESS;
+}
+
+void
+VfsCloseFile(VfsFile* file) {
+    PlatformUnmapFile(&file->Mapping);
+    free(file->Memory);
+    memset(file, 0, sizeof(VfsFile));
+}
+
+int
+VfsReadFile(const char* filePath, void* destination, size_t capacity) {
+    const PackEntry* Entry = FindEntry(filePath);
+    if(Entry) {
+        if(Entry->Size > capacity) {
+            return VFS_FAIL;
+        }
+        if(Entry->NumBlocks) {
+            return DecompressEntry(Entry, destination);
+        }
+        memcpy(destination, sPack.Data + Entry->Offset, (size_t)Entry->Size);
+        return VFS_SUCCESS;
+    }
+
+    MappedFile File;
+    if(!PlatformMapFile(filePath, &File)) {
+        return VFS_FAIL;
+    }
+    int Result = File.Size <= capacity;
+    if(Result) {
+        memcpy(destination, File.Data, File.Size);
+    }
+    PlatformUnmapFile(&File);
+    return Result ? VFS_SUCCESS : VFS_FAIL;
+}
+
+int
+VfsFileStat(const char* filePath, uint64_t* size, int64_t* modifiedTime) {
+    const PackEntry* Entry = FindEntry(filePath);
+    if(!Entry) {
+        return PlatformFileStat(filePath, size, modifiedTime);
+    }
+
+    *size = Entry->Size;
+    *modifiedTime = sPackModifiedTime;
+    return VFS_SUCCESS;
+}
+
+int
+VfsIsPacked(const char* filePath) {
+    return FindEntry(filePath) != NULL;
+}
+
+static int
+WritePadding(FILE* file, uint64_t* offset) {
+    static const char Zeros[VFS_PACK_ALIGNMENT];
+    size_t Padding = (size_t)(AlignUp(*offset) - *offset);
+    *offset += Padding;
+    return fwrite(Zeros, 1, Padding, file) == Padding;
+}
+
+typedef struct CompressJob {
+    const unsigned char* Source;
+    uint64_t Size;
+    unsigned char* Blocks;
+    uint32_t* BlockSizes;
+} CompressJob;
+
+static void
+CompressBlock(void* data, unsigned blockIdx) {
+    CompressJob* Job = (CompressJob*)data;
+    uint64_t Begin = (uint64_t)blockIdx * VFS_BLOCK_SIZE;
+    size_t RawSize = (size_t)(Job->Size - Begin < VFS_BLOCK_SIZE ? Job->Size - Begin : VFS_BLOCK_SIZE);
+    unsigned char* Block = Job->Blocks + Begin;
+    // NOTE(Jovan): Block that doesn't shrink is stored raw, its size alone tells the reader
+    size_t StoredSize = LzCompress(Job->Source + Begin, RawSize, Block, RawSize - 1);
+    if(!StoredSize) {
+        memcpy(Block, Job->Source + Begin, RawSize);
+        StoredSize = RawSize;
+    }
+    Job->BlockSizes[blockIdx] = (uint32_t)StoredSize;
+}
+
+/**
+ * @brief Writes entry data compressed when asked for and worth it, raw otherwise
+ *
+ * @return int 0 if writing failed
+ */
+static int
+WriteEntryData(FILE* file, const MappedFile* source, int compress, PackEntry* entry) {
+    entry->Size = source->Size;
+    entry->StoredSize = source->Size;
+    entry->NumBlocks = 0;
+    uint32_t NumBlocks = (uint32_t)((source->Size + VFS_BLOCK_SIZE - 1) / VFS_BLOCK_SIZE);
+    CompressJob Job = { 0 };
+    if(compress && NumBlocks) {
+        Job.Source = (const unsigned char*)source->Data;
+        Job.Size = source->Size;
+        Job.Blocks = (unsigned char*)malloc(source->Size);
+        Job.BlockSizes = (uint32_t*)malloc(NumBlocks * sizeof(uint32_t));
+    }
+
+    if(Job.Blocks && Job.BlockSizes) {
+        JobParallelFor(NumBlocks, CompressBlock, &Job);
+        uint64_t StoredSize = (uint64_t)NumBlocks * sizeof(uint32_t);
+        for(uint32_t BlockIdx = 0; BlockIdx < NumBlocks; ++BlockIdx) {
+            StoredSize += Job.BlockSizes[BlockIdx];
+        }
+        if(StoredSize <= source->Size - source->Size / VFS_MIN_SAVING) {
+            entry->StoredSize = StoredSize;
+            entry->NumBlocks = NumBlocks;
+        }
+    }
+
+    int Written = 1;
+    if(entry->NumBlocks) {
+        Written = fwrite(Job.BlockSizes, sizeof(uint32_t), NumBlocks, file) == NumBlocks;
+        for(uint32_t BlockIdx = 0; Written && BlockIdx < NumBlocks; ++BlockIdx) {
+            const unsigned char* Block = Job.Blocks + (uint64_t)BlockIdx * VFS_BLOCK_SIZE;
+            Written = fwrite(Block, 1, Job.BlockSizes[BlockIdx], file) == Job.BlockSizes[BlockIdx];
+        }
+    } else {
+        Written = fwrite(source->Data, 1, source->Size, file) == source->Size;
+    }
+
+    free(Job.Blocks);
+    free(Job.BlockSizes);
+    return Written;
+}
+
+static int
+WritePackContents(FILE* file, const char* const* filePaths, unsigned numFiles, int compress, PackHeader* header,
+                  PackEntry* slots, char* strings) {
+    char Path[VFS_MAX_PATH];
+    uint32_t Mask = header->NumSlots - 1;
+    uint32_t StringsSize = 0;
+    uint64_t Offset = sizeof(PackHeader);
+    if(fwrite(header, sizeof(PackHeader), 1, file) != 1) {
+        return 0;
+    }
+
+    for(unsigned FileIdx = 0; FileIdx < numFiles; ++FileIdx) {
+        size_t Length = NormalizePath(filePaths[FileIdx], Path);
+        if(!Length) {
+            fprintf(stderr, "Asset path %s is too long.\n", filePaths[FileIdx]);
+            return 0;
+        }
+
+        uint64_t Hash = HashBytes(Path, Length, 0);
+        uint32_t SlotIdx = (uint32_t)Hash & Mask;
+        int Duplicate = 0;
+        while(slots[SlotIdx].PathLength) {
+            const PackEntry* Curr = &slots[SlotIdx];
+            Duplicate |= Curr->PathHash == Hash && Curr->PathLength == Length && !memcmp(strings + Curr->PathOffset, Path, Length);
+            SlotIdx = (SlotIdx + 1) & Mask;
+        }
+        if(Duplicate) {
+            fprintf(stderr, "Skipping duplicate asset %s.\n", filePaths[FileIdx]);
+            continue;
+        }
+
+        MappedFile Source;
+        if(!PlatformMapFile(filePaths[FileIdx], &Source)) {
+            fprintf(stderr, "Failed to open asset %s.\n", filePaths[FileIdx]);
+            return 0;
+        }
+
+        PackEntry* Entry = &slots[SlotIdx];
+        int Written = WritePadding(file, &Offset) && WriteEntryData(file, &Source, compress, Entry);
+        Entry->PathHash = Hash;
+        Entry->Offset = Offset;
+        Entry->PathOffset = StringsSize;
+        Entry->PathLength = (uint32_t)Length;
+        memcpy(strings + StringsSize, Path, Length);
+        StringsSize += (uint32_t)Length;
+        Offset += Entry->StoredSize;
+        ++header->NumEntries;
+        PlatformUnmapFile(&Source);
+        if(!Written) {
+            return 0;
+        }
+    }
+
+    if(!WritePadding(file, &Offset)) {
+        return 0;
+    }
+    header->TocOffset = Offset;
+    header->StringsOffset = Offset + (uint64_t)header->NumSlots * sizeof(PackEntry);
+    header->FileSize = header->StringsOffset + StringsSize;
+    return fwrite(slots, sizeof(PackEntry), header->NumSlots, file) == header->NumSlots
+           && fwrite(strings, 1, StringsSize, file) == StringsSize && !fseek(file, 0, SEEK_SET)
+           && fwrite(header, sizeof(PackHeader), 1, file) == 1;
+}
+
+int
+WriteAssetPack(const char* packPath, const char* const* filePaths, unsigned numFiles, int compress) {
+    char TempPath[VFS_MAX_PATH + 8];
+    if(strlen(packPath) >= VFS_MAX_PATH) {
+        fprintf(stderr, "Asset pack path %s is too long.\n", packPath);
+        return VFS_FAIL;
+    }
+
+    // NOTE(Jovan): Table is kept at most half full so probe sequences stay short
+    PackHeader Header = { 0 };
+    Header.Magic = VFS_PACK_MAGIC;
+    Header.Version = VFS_PACK_VERSION;
+    Header.NumSlots = 2;
+    while(Header.NumSlots < 2 * numFiles) {
+        Header.NumSlots *= 2;
+    }
+
+    PackEntry* Slots = (PackEntry*)calloc(Header.NumSlots, sizeof(PackEntry));
+    char* Strings = (char*)malloc((size_t)numFiles * VFS_MAX_PATH + 1);
+    if(!Slots || !Strings) {
+        fprintf(stderr, "Failed to allocate asset pack table.\n");
+        free(Slots);
+        free(Strings);
+        return VFS_FAIL;
+    }
+
+    // NOTE(Jovan): Write to side file and swap, so a mounted pack is never seen half written
+    strcpy(TempPath, packPath);
+    strcat(TempPath, ".tmp");
+    FILE* File = fopen(TempPath, "wb");
+    if(!File) {
+        fprintf(stderr, "Failed to create asset pack %s.\n", TempPath);
+        free(Slots);
+        free(Strings);
+        return VFS_FAIL;
+    }
+
+    int Written = WritePackContents(File, filePaths, numFiles, compress, &Header, Slots, Strings);
+    int Closed = fclose(File) == 0;
+    free(Slots);
+    free(Strings);
+    if(!Written || !Closed || !PlatformReplaceFile(TempPath, packPath)) {
+        fprintf(stderr, "Failed to write asset pack %s.\n", packPath);
+        remove(TempPath);
+        return VFS_FAIL;
+    }
+
+    fprintf(stdout, "Packed %u assets into %s, %llu bytes.\n", Header.NumEntries, packPath,
+            (unsigned long long)Header.FileSize);
+    return VFS_SUCCESS;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file vfs.h
+ * @author Jovan Ivosevic
+ * @brief Read-only virtual file system over a single memory mapped asset pack
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+
+#ifndef VFS_H
+#define VFS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "platform.h"
+
+#define VFS_SUCCESS 1
+#define VFS_FAIL 0
+#define VFS_PACK_MAGIC 0x4B41504Du
+#define VFS_PACK_VERSION 2
+// NOTE(Jovan): Entry data starts on a cache line, views can be handed to SIMD parsers and GL as is
+#define VFS_PACK_ALIGNMENT 64
+#define VFS_DEFAULT_PACK "assets.pak"
+#define VFS_MAX_PATH 512
+// NOTE(Jovan): Compressed entries are cut into independent blocks of this size, decompressed in parallel
+#define VFS_BLOCK_SIZE (128u << 10)
+// NOTE(Jovan): Entries stay uncompressed unless the codec saves at least 1/VFS_MIN_SAVING of them, already
+//              compressed formats (PNG, JPG) keep their zero-copy views
+#define VFS_MIN_SAVING 8
+
+/**
+ * @brief Pack header. Entry data follows the header, then the table of contents and the path strings.
+ *        Table of contents is an open addressing hash table of NumSlots entries keyed by path hash,
+ *        probed linearly from PathHash & (NumSlots - 1). Empty slots have zero PathLength.
+ *        Packs are written in native byte order.
+ *        Compressed entries (nonzero NumBlocks) store a table of NumBlocks uint32_t compressed block
+ *        sizes followed by the blocks. Blocks whose stored size equals their raw size are kept raw.
+ *
+ */
+typedef struct PackHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t NumEntries;
+    uint32_t NumSlots;
+    uint64_t TocOffset;
+    uint64_t StringsOffset;
+    uint64_t FileSize;
+} PackHeader;
+
+typedef struct PackEntry {
+    uint64_t PathHash;
+    uint64_t Offset;
+    uint64_t Size;
+    uint64_t StoredSize;
+    uint32_t PathOffset;
+    uint32_t PathLength;
+    uint32_t NumBlocks;
+    uint32_t Padding;
+} PackEntry;
+
+/**
+ * @brief Opened file. Uncompressed files found in the pack are views into the pack mapping, compressed
+ *        ones are decompressed into Memory and others are mapped from disk. Modification time is the one
+ *        of the opened contents, packed files report the time of the pack like VfsFileStat.
+ *
+ */
+typedef struct VfsFile {
+    const char* Data;
+    size_t Size;
+    int64_t ModifiedTime;
+    MappedFile Mapping;
+    void* Memory;
+} VfsFile;
+
+/**
+ * @brief Maps asset pack and serves its files from then on. Mount before starting loads, the pack
+ *        is shared by all threads without locking.
+ *
+ * @param packPath Pack file path
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int VfsMount(const char* packPath);
+
+/**
+ * @brief Unmaps asset pack. Views returned by VfsOpenFile become invalid.
+ *
+ */
+void VfsUnmount(void);
+
+/**
+ * @brief Opens file for reading, pack first and disk otherwise
+ *
+ * @param filePath Relative file path, slashes in either direction
+ * @param file Result, filled on success. Release with VfsCloseFile.
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int VfsOpenFile(const char* filePath, VfsFile* file);
+
+/**
+ * @brief Closes file opened with VfsOpenFile. Safe to call on zeroed struct.
+ *
+ * @param file File
+ */
+void VfsCloseFile(VfsFile* file);
+
+/**
+ * @brief Reads whole file into caller memory, e.g. a staging buffer or a mapped GL buffer.
+ *        Compressed files are decompressed straight into it, block by block on the job system.
+ *
+ * @param filePath Relative file path
+ * @param destination Output memory, at least the size reported by VfsFileStat
+ * @param capacity Size of output memory
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int VfsReadFile(const char* filePath, void* destination, size_t capacity);
+
+/**
+ * @brief Queries file size and modification time. Packed files report the time of the pack.
+ *
+ * @param filePath Relative file path
+ * @param size Output file size in bytes
+ * @param modifiedTime Output modification time, opaque platform units
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int VfsFileStat(const char* filePath, uint64_t* size, int64_t* modifiedTime);
+
+/**
+ * @brief Checks whether file is served from the mounted pack, in which case its loose copy is never read
+ *
+ * @param filePath Relative file path
+ * @return int 1 if the pack has the file, 0 otherwise
+ */
+int VfsIsPacked(const char* filePath);
+
+/**
+ * @brief Concatenates loose files into a pack, stored under the paths as given
+ *
+ * @param packPath Output pack path
+ * @param filePaths Relative paths of files to pack
+ * @param numFiles Number of files
+ * @param compress Nonzero compresses entries that shrink enough, blocks are compressed on the job system
+ * @return int Success, 0 - FAIL, 1 - SUCCESS
+ */
+int WriteAssetPack(const char* packPath, const char* const* filePaths, unsigned numFiles, int compress);
+
+#endif